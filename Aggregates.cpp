@@ -0,0 +1,162 @@
+#include "Aggregates.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Groups the valued rows of the house table by (state, name column) and summarizes each group
+std::vector<PlaceStats> placeStats(const HouseTable& houseTable, const std::vector<StringId>& names) {
+    std::unordered_map<std::uint64_t, std::size_t> slots;
+    std::vector<PlaceStats> places;
+    std::vector<std::vector<double>> values;
+    for (std::size_t row = 0; row < houseTable.rows(); row++) {
+        if (isMissing(houseTable.MeanValue[row])) {
+            continue;
+        }
+        std::uint64_t key = (static_cast<std::uint64_t>(houseTable.State[row]) << 32) | names[row];
+        auto slot = slots.emplace(key, places.size());
+        if (slot.second) {
+            places.push_back({houseTable.State[row], names[row], ValueStats()});
+            values.emplace_back();
+        }
+        values[slot.first->second].push_back(houseTable.MeanValue[row]);
+    }
+    for (std::size_t i = 0; i < places.size(); i++) {
+        places[i].stats = summarize(values[i]);
+    }
+    return places;
+}
+
+}
+
+const SalaryAggregate* SalaryIndex::find(StringId title) const {
+    auto slot = titleSlots.find(title);
+    if (slot == titleSlots.end()) {
+        return nullptr;
+    }
+    return &aggregates[static_cast<std::size_t>(slot->second) * stateCount];
+}
+
+std::size_t SalaryIndex::memoryBytes() const {
+    return aggregates.capacity() * sizeof(SalaryAggregate) +
+           titleSlots.size() * (sizeof(StringId) + sizeof(std::uint32_t) + 2 * sizeof(void*)) +
+           titleSlots.bucket_count() * sizeof(void*);
+}
+
+SalaryIndex buildSalaryIndex(const OccupationTable& occupationTable) {
+    SalaryIndex index;
+    index.stateCount = occupationTable.states.size();
+    for (std::size_t row = 0; row < occupationTable.rows(); row++) {
+        auto slot = index.titleSlots.emplace(occupationTable.OCC_TITLE[row],
+                                             static_cast<std::uint32_t>(index.titleSlots.size()));
+        if (slot.second) {
+            index.aggregates.resize(index.aggregates.size() + index.stateCount);
+        }
+        SalaryAggregate& aggregate =
+                index.aggregates[static_cast<std::size_t>(slot.first->second) * index.stateCount +
+                                 occupationTable.PRIM_STATE[row]];
+        aggregate.add(occupationTable.A_MEAN[row], occupationTable.TOT_EMP[row]);
+    }
+    return index;
+}
+
+void compensatedAdd(double& sum, double& compensation, double value) {
+    double next = sum + value;
+    if (std::fabs(sum) >= std::fabs(value)) {
+        compensation += (sum - next) + value;
+    } else {
+        compensation += (value - next) + sum;
+    }
+    sum = next;
+}
+
+void SalaryAggregate::add(double aMean, double totEmp) {
+    if (!isMissing(aMean)) {
+        compensatedAdd(sumMean, meanCompensation, aMean);
+        count++;
+    }
+    if (!isMissing(totEmp)) {
+        compensatedAdd(sumEmployment, employmentCompensation, totEmp);
+    }
+}
+
+double compensatedSum(const std::vector<double>& values) {
+    double sum = 0.0, compensation = 0.0;
+    for (double value : values) {
+        compensatedAdd(sum, compensation, value);
+    }
+    return sum + compensation;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return missingValue;
+    }
+    double rank = p * static_cast<double>(sorted.size() - 1);
+    std::size_t below = static_cast<std::size_t>(rank);
+    if (below + 1 >= sorted.size()) {
+        return sorted.back();
+    }
+    double fraction = rank - static_cast<double>(below);
+    return sorted[below] + (sorted[below + 1] - sorted[below]) * fraction;
+}
+
+ValueStats summarize(std::vector<double>& values) {
+    values.erase(std::remove_if(values.begin(), values.end(), isMissing), values.end());
+    std::sort(values.begin(), values.end());
+
+    ValueStats stats;
+    stats.count = static_cast<std::uint32_t>(values.size());
+    if (values.empty()) {
+        return stats;
+    }
+    stats.sum = compensatedSum(values);
+    stats.mean = stats.sum / static_cast<double>(values.size());
+    stats.min = values.front();
+    stats.p10 = percentile(values, 0.10);
+    stats.p25 = percentile(values, 0.25);
+    stats.median = percentile(values, 0.50);
+    stats.p75 = percentile(values, 0.75);
+    stats.p90 = percentile(values, 0.90);
+    stats.max = values.back();
+    return stats;
+}
+
+void RunningStats::add(double value) {
+    if (isMissing(value)) {
+        return;
+    }
+    compensatedAdd(sum, compensation, value);
+    min = (count == 0 || value < min) ? value : min;
+    max = (count == 0 || value > max) ? value : max;
+    count++;
+}
+
+ValueStats RunningStats::stats() const {
+    ValueStats stats;
+    stats.count = count;
+    if (count == 0) {
+        return stats;
+    }
+    stats.sum = sum + compensation;
+    stats.mean = stats.sum / static_cast<double>(count);
+    stats.min = min;
+    stats.max = max;
+    return stats;
+}
+
+HomeValueStats buildHomeValueStats(const HouseTable& houseTable) {
+    HomeValueStats homeStats;
+    std::vector<std::vector<double>> values(houseTable.states.size());
+    for (std::size_t row = 0; row < houseTable.rows(); row++) {
+        values[houseTable.State[row]].push_back(houseTable.MeanValue[row]);
+    }
+    homeStats.byState.reserve(values.size());
+    for (std::vector<double>& stateValues : values) {
+        homeStats.byState.push_back(summarize(stateValues));
+    }
+    homeStats.byCounty = placeStats(houseTable, houseTable.CountyName);
+    homeStats.byCity = placeStats(houseTable, houseTable.City);
+    return homeStats;
+}
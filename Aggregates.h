@@ -0,0 +1,120 @@
+#ifndef PROJECT3_AGGREGATES_H
+#define PROJECT3_AGGREGATES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ColumnTable.h"
+#include "Records.h"
+#include "StringPool.h"
+
+// Function to add value to a running sum with Neumaier compensation: the low-order bits each
+// addition loses are gathered in compensation, and sum + compensation is the total
+void compensatedAdd(double& sum, double& compensation, double value);
+
+// Salary totals of one occupation title in one state, summed with compensatedAdd so rounding does
+// not build up with the order the rows arrive in, which differs between the full load and --stream.
+// count is the number of rows with an A_MEAN; TOT_EMP sums the rows that report one
+struct SalaryAggregate {
+    double sumMean = 0.0;
+    double meanCompensation = 0.0;
+    std::uint32_t count = 0;
+    double sumEmployment = 0.0;
+    double employmentCompensation = 0.0;
+
+    // Adds one row; missing values are left out
+    void add(double aMean, double totEmp);
+
+    double mean() const { return count != 0 ? (sumMean + meanCompensation) / count : 0.0; }
+    double employment() const { return sumEmployment + employmentCompensation; }
+};
+
+// Class holding a (title, state) -> SalaryAggregate table, built once from the salary columns.
+// Each title owns one contiguous run of entries indexed by the occupation table's state ids,
+// so the salary side of a query is a single lookup followed by a walk over the states.
+class SalaryIndex {
+public:
+    // Aggregates of title in every state, or nullptr if the title has no rows
+    const SalaryAggregate* find(StringId title) const;
+
+    std::size_t states() const { return stateCount; }
+    std::size_t titles() const { return titleSlots.size(); }
+    std::size_t memoryBytes() const;
+
+private:
+    friend SalaryIndex buildSalaryIndex(const OccupationTable& occupationTable);
+    friend class SnapshotCodec;
+    friend class StreamingAggregator;
+
+    std::size_t stateCount = 0;
+    std::unordered_map<StringId, std::uint32_t> titleSlots;
+    std::vector<SalaryAggregate> aggregates;
+};
+
+// Function to build the salary index with one pass over the occupation table
+SalaryIndex buildSalaryIndex(const OccupationTable& occupationTable);
+
+// Summary of one group of home values; missing values are left out of every field.
+// Percentiles interpolate linearly between the closest ranks, and all but count are
+// missingValue when the group has no values.
+struct ValueStats {
+    std::uint32_t count = 0;
+    double sum = 0.0;
+    double mean = missingValue;
+    double min = missingValue;
+    double p10 = missingValue;
+    double p25 = missingValue;
+    double median = missingValue;
+    double p75 = missingValue;
+    double p90 = missingValue;
+    double max = missingValue;
+};
+
+// Function to sum values with Neumaier's compensation, so rounding error does not build up over many rows
+double compensatedSum(const std::vector<double>& values);
+
+// Function returning the value at fraction p (0 to 1) of ascending values, interpolating between neighbours
+double percentile(const std::vector<double>& sorted, double p);
+
+// Function to summarize a group of values; sorts values in place and drops the missing ones
+ValueStats summarize(std::vector<double>& values);
+
+// Class summarizing values seen one at a time, for when the values themselves are not kept.
+// The sum is compensated as in compensatedSum; percentiles need every value, so they stay missing.
+class RunningStats {
+public:
+    void add(double value);
+    ValueStats stats() const;
+
+private:
+    std::uint32_t count = 0;
+    double sum = 0.0;
+    double compensation = 0.0;
+    double min = missingValue;
+    double max = missingValue;
+};
+
+// Statistics of one county or city, identified by its state id and name
+struct PlaceStats {
+    std::uint32_t state;
+    StringId name;
+    ValueStats stats;
+};
+
+// Class holding home value statistics per state, county and city, computed once from the house table.
+// Counties and cities are listed in order of their first row; both are keyed by state, since
+// the same name turns up in several states.
+class HomeValueStats {
+public:
+    // Indexed by the house table's state ids
+    std::vector<ValueStats> byState;
+    std::vector<PlaceStats> byCounty;
+    std::vector<PlaceStats> byCity;
+};
+
+// Function to build the home value statistics with one grouping pass over the house table
+HomeValueStats buildHomeValueStats(const HouseTable& houseTable);
+
+#endif //PROJECT3_AGGREGATES_H
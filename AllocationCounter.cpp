@@ -0,0 +1,92 @@
+#include "AllocationCounter.h"
+
+#ifdef PROJECT3_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+// Retries through the new handler like the default operator new does
+template <typename Allocate>
+void* allocateOrThrow(Allocate allocate) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    while (true) {
+        if (void* pointer = allocate()) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+}
+
+std::size_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+// The array, nothrow and sized forms all forward to these in the standard library.
+// The aligned forms are replaced too because std::pmr::new_delete_resource uses them.
+void* operator new(std::size_t size) {
+    return allocateOrThrow([size]() { return std::malloc(size == 0 ? 1 : size); });
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    std::size_t rounded = (size + align - 1) / align * align;
+    return allocateOrThrow([rounded, align]() {
+#ifdef _WIN32
+        return _aligned_malloc(rounded == 0 ? align : rounded, align);
+#else
+        return std::aligned_alloc(align, rounded == 0 ? align : rounded);
+#endif
+    });
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(pointer, alignment);
+}
+
+bool allocationCountEnabled() {
+    return true;
+}
+
+#else
+
+std::size_t allocationCount() {
+    return 0;
+}
+
+bool allocationCountEnabled() {
+    return false;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef PROJECT3_ALLOCATIONCOUNTER_H
+#define PROJECT3_ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+// Function that returns how many times the global operator new has been called.
+// Only counted in builds with PROJECT3_COUNT_ALLOCATIONS defined (the CMake option of
+// the same name), where AllocationCounter.cpp replaces operator new/delete for the
+// whole program at the cost of one relaxed atomic increment per allocation; elsewhere
+// it stays 0 and the standard library's allocator is left alone.
+std::size_t allocationCount();
+
+// Function that returns whether allocationCount counts anything in this build
+bool allocationCountEnabled();
+
+#endif //PROJECT3_ALLOCATIONCOUNTER_H
@@ -0,0 +1,156 @@
+#include "Batch.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iomanip>
+
+namespace {
+
+// Titles handed to one pool task; a ranking takes about a microsecond, so fewer would be all overhead
+const std::size_t batchGrain = 64;
+
+// Quotes a CSV field when it holds a delimiter, quote or line break, doubling any quotes inside
+void writeCsvField(std::string_view value, std::ostream& out) {
+    if (value.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out << value;
+        return;
+    }
+    out << '"';
+    for (char c : value) {
+        if (c == '"') {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+}
+
+std::vector<std::string> allTitles(const Dataset& dataset) {
+    return std::vector<std::string>(dataset.occupationNames.begin(), dataset.occupationNames.end());
+}
+
+bool readTitleList(const std::string& path, std::vector<std::string>& titles) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            titles.push_back(line);
+        }
+    }
+    return true;
+}
+
+std::vector<TitleRanking> rankStatesBatch(const std::vector<std::string>& titles, std::size_t numStates,
+                                          const Dataset& dataset, ThreadPool& pool) {
+    const std::vector<float> homeValues = homeValueByOccupationState(dataset);
+    std::vector<TitleRanking> rankings(titles.size());
+    std::vector<std::future<void>> pending;
+    for (std::size_t begin = 0; begin < titles.size(); begin += batchGrain) {
+        std::size_t end = std::min(begin + batchGrain, titles.size());
+        pending.push_back(pool.submit([&, begin, end]() {
+            for (std::size_t i = begin; i < end; i++) {
+                rankings[i].title = titles[i];
+                rankings[i].states = rankStates(titles[i], numStates, homeValues, dataset);
+            }
+        }));
+    }
+    for (std::future<void>& task : pending) {
+        task.get();
+    }
+    return rankings;
+}
+
+void writeRankingsCsv(const std::vector<TitleRanking>& rankings, std::ostream& out) {
+    out << "title,rank,state,job_salary,home_value,score\n";
+    out << std::fixed << std::setprecision(2);
+    for (const TitleRanking& ranking : rankings) {
+        for (std::size_t rank = 0; rank < ranking.states.size(); rank++) {
+            const PlaceScore& place = ranking.states[rank];
+            writeCsvField(ranking.title, out);
+            out << ',' << rank + 1 << ',' << place.state << ',' << place.jobSalary << ',' << place.homeValue << ','
+                << place.score << '\n';
+        }
+    }
+}
+
+void writeRankingsJson(const std::vector<TitleRanking>& rankings, std::ostream& out) {
+    out << std::fixed << std::setprecision(2) << "[";
+    for (std::size_t i = 0; i < rankings.size(); i++) {
+        out << (i == 0 ? "\n" : ",\n") << "  {\"title\": ";
+        writeJsonString(rankings[i].title, out);
+        out << ", \"states\": [";
+        const std::vector<PlaceScore>& states = rankings[i].states;
+        for (std::size_t rank = 0; rank < states.size(); rank++) {
+            out << (rank == 0 ? "" : ", ") << "{\"rank\": " << rank + 1 << ", \"state\": ";
+            writeJsonString(states[rank].state, out);
+            out << ", \"jobSalary\": " << states[rank].jobSalary << ", \"homeValue\": " << states[rank].homeValue
+                << ", \"score\": " << states[rank].score << "}";
+        }
+        out << "]}";
+    }
+    out << (rankings.empty() ? "]\n" : "\n]\n");
+}
+
+void writeRankingsText(const std::vector<TitleRanking>& rankings, std::ostream& out) {
+    for (std::size_t i = 0; i < rankings.size(); i++) {
+        out << (i == 0 ? "" : "\n") << rankings[i].title << std::endl;
+        for (const PlaceScore& place : rankings[i].states) {
+            printPlace(place, out);
+        }
+    }
+}
+
+void writeRankings(const std::vector<TitleRanking>& rankings, ReportFormat format, std::ostream& out) {
+    switch (format) {
+        case ReportFormat::Json:
+            writeRankingsJson(rankings, out);
+            break;
+        case ReportFormat::Csv:
+            writeRankingsCsv(rankings, out);
+            break;
+        default:
+            writeRankingsText(rankings, out);
+    }
+}
+
+void writeJsonString(std::string_view value, std::ostream& out) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\r':
+                out << "\\r";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
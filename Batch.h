@@ -0,0 +1,52 @@
+#ifndef PROJECT3_BATCH_H
+#define PROJECT3_BATCH_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Dataset.h"
+#include "Queries.h"
+#include "ThreadPool.h"
+
+// Formats a batch of rankings can be written in: Text is the interactive session's listing
+enum class ReportFormat { Text, Csv, Json };
+
+// The ranked states of one title in a batch
+struct TitleRanking {
+    std::string title;
+    std::vector<PlaceScore> states;
+};
+
+// Function returning every loaded occupation title in alphabetical order, for a batch over "all"
+std::vector<std::string> allTitles(const Dataset& dataset);
+
+// Function to read a list of titles, one per line, skipping blank lines; returns false if the file cannot be opened
+bool readTitleList(const std::string& path, std::vector<std::string>& titles);
+
+// Function to rank the numStates best states for every title at once. The salaries come from the
+// salary index built in the one scan over the salary data at load, the home values per state are
+// worked out once for the whole batch, and the titles are split across the pool. Results are in the
+// order of titles, each the same as top5States would print for it.
+std::vector<TitleRanking> rankStatesBatch(const std::vector<std::string>& titles, std::size_t numStates,
+                                          const Dataset& dataset, ThreadPool& pool);
+
+// Function to write rankings as CSV, one row per ranked state: title,rank,state,job_salary,home_value,score
+void writeRankingsCsv(const std::vector<TitleRanking>& rankings, std::ostream& out);
+
+// Function to write rankings as a JSON array of {"title", "states": [{"rank", "state", "jobSalary",
+// "homeValue", "score"}]} objects
+void writeRankingsJson(const std::vector<TitleRanking>& rankings, std::ostream& out);
+
+// Function to write rankings as text: each title on a line of its own, followed by its states as top5States prints them
+void writeRankingsText(const std::vector<TitleRanking>& rankings, std::ostream& out);
+
+// Function to write rankings in the given format
+void writeRankings(const std::vector<TitleRanking>& rankings, ReportFormat format, std::ostream& out);
+
+// Function to write value as a quoted JSON string, escaping quotes, backslashes and control characters
+void writeJsonString(std::string_view value, std::ostream& out);
+
+#endif //PROJECT3_BATCH_H
@@ -0,0 +1,1518 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#endif
+#endif
+
+
+#include "AllocationCounter.h"
+#include "Batch.h"
+#include "ColumnTable.h"
+#include "CsvLoader.h"
+#include "CsvScanner.h"
+#include "Dataset.h"
+#include "NumberParse.h"
+#include "Queries.h"
+#include "RadixSort.h"
+#include "Snapshot.h"
+#include "Records.h"
+#include "Server.h"
+#include "Sorting.h"
+#include "Streaming.h"
+#include "StringPool.h"
+#include "ThreadPool.h"
+#include "TopK.h"
+
+namespace {
+
+const int benchRuns = 5;
+
+// Runs fn benchRuns times, reports the best and average time in milliseconds and returns the best
+double timeRuns(const std::string& label, const std::function<void()>& fn) {
+    double best = 0.0, total = 0.0;
+    for (int run = 0; run < benchRuns; run++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto stop = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() / 1000.0;
+        best = (run == 0 || ms < best) ? ms : best;
+        total += ms;
+    }
+    std::cout << "  " << label << " Time in Milliseconds: best " << best << ", average " << total / benchRuns << std::endl;
+    return best;
+}
+
+// Prints bytes processed per second for a best-of time in milliseconds
+void printThroughput(const std::string& label, std::size_t bytes, double bestMs) {
+    double seconds = bestMs / 1000.0;
+    std::cout << "  " << label << " GB/s: " << (seconds > 0 ? bytes / seconds / 1e9 : 0.0) << std::endl;
+}
+
+// Approximate resident bytes of a per-state record map: tree nodes and vector buffers.
+// The text lives once in stringPool() and is reported separately.
+template <typename T>
+std::size_t recordMemoryBytes(const StateMap<T>& data) {
+    std::size_t bytes = 0;
+    for (const auto& entry : data) {
+        bytes += sizeof(entry) + 4 * sizeof(void*) + entry.second.capacity() * sizeof(T);
+    }
+    return bytes;
+}
+
+// Current resident set size of the process, 0 where /proc is not available
+std::size_t residentBytes() {
+#ifndef _WIN32
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0, resident = 0;
+    if (statm >> pages >> resident) {
+        return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+void printMegabytes(const std::string& label, std::size_t bytes) {
+    std::cout << "  " << label << ": " << bytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+}
+
+// The original getline/istringstream ingest, kept as the baseline for the loader benchmarks
+void legacyLoadHouseData(const std::string& path, HouseMap& houseData) {
+    std::ifstream homeCostFile(path);
+    std::string homeCostLine;
+    std::getline(homeCostFile, homeCostLine);
+    while (std::getline(homeCostFile, homeCostLine))
+    {
+        std::istringstream iss(homeCostLine);
+        std::string RegionIDStr, StateStr, CityStr, CountyNameStr, MeanValueStr;
+
+        std::getline(iss, RegionIDStr, ',');
+        std::getline(iss, StateStr, ',');
+        std::getline(iss, CityStr, ',');
+        std::getline(iss, CountyNameStr, ',');
+        std::getline(iss, MeanValueStr, ',');
+
+        double MeanValue = isdigit(MeanValueStr[0]) ? std::stod(MeanValueStr) : 0.0;
+        StringPool& strings = stringPool();
+        houseData[StateStr].push_back(HouseInfo(strings.intern(RegionIDStr), strings.intern(StateStr), strings.intern(CityStr),
+                                                strings.intern(CountyNameStr), MeanValue));
+    }
+}
+
+void legacyLoadOccupationData(const std::string& path, OccupationMap& occupationData,
+                              std::map<std::string, std::string>& occupationNames) {
+    std::ifstream OccupationDataFile(path);
+    std::string OccupationDataLine;
+    std::getline(OccupationDataFile, OccupationDataLine);
+    while (std::getline(OccupationDataFile, OccupationDataLine))
+    {
+        std::istringstream iss(OccupationDataLine);
+        std::string AREA, PRIM_STATE, OCC_TITLE, S_TOT_EMP, S_A_MEAN;
+
+        std::getline(iss, AREA, ',');
+        std::getline(iss, PRIM_STATE, ',');
+        std::getline(iss, OCC_TITLE, ',');
+        std::getline(iss, S_TOT_EMP, ',');
+        std::getline(iss, S_A_MEAN, ',');
+
+        double TOT_EMP = isdigit(S_TOT_EMP[0]) ? std::stod(S_TOT_EMP) : 0.0;
+        double A_MEAN = isdigit(S_A_MEAN[0]) ? std::stod(S_A_MEAN) : 0.0;
+
+        StringPool& strings = stringPool();
+        occupationData[PRIM_STATE].push_back(Occupation(strings.intern(AREA), strings.intern(PRIM_STATE),
+                                                        strings.intern(OCC_TITLE), TOT_EMP, A_MEAN));
+        occupationNames[OCC_TITLE] = OCC_TITLE;
+    }
+}
+
+bool fileExists(const std::string& path) {
+    std::ifstream file(path);
+    return file.is_open();
+}
+
+// Startup cost of the getline/istringstream ingest versus the memory-mapped loader
+void benchLoaders(const std::string& housePath, const std::string& occupationPath) {
+    std::cout << "Loader startup (" << benchRuns << " runs each)" << std::endl;
+
+    timeRuns("Legacy PropertyValues.csv", [&]() {
+        HouseMap houseData;
+        legacyLoadHouseData(housePath, houseData);
+    });
+    timeRuns("Mapped PropertyValues.csv", [&]() {
+        HouseMap houseData;
+        loadHouseData(housePath, houseData);
+    });
+
+    if (!fileExists(occupationPath)) {
+        std::cout << "  " << occupationPath << " not found, skipping salary loader" << std::endl;
+        return;
+    }
+    timeRuns("Legacy JobSalarys.csv", [&]() {
+        OccupationMap occupationData;
+        std::map<std::string, std::string> occupationNames;
+        legacyLoadOccupationData(occupationPath, occupationData, occupationNames);
+    });
+    timeRuns("Mapped JobSalarys.csv", [&]() {
+        OccupationMap occupationData;
+        std::set<std::string_view> occupationNames;
+        loadOccupationData(occupationPath, occupationData, occupationNames);
+    });
+}
+
+// Heap allocations and time for one load: the getline ingest, the chunked loader into
+// heap-backed maps, and the chunked loader into a Dataset's arenas
+void benchAllocations(const std::string& housePath, const std::string& occupationPath) {
+    std::cout << "Allocations per load of both files" << std::endl;
+    if (!allocationCountEnabled()) {
+        std::cout << "  Not counted in this build; configure with -DPROJECT3_COUNT_ALLOCATIONS=ON" << std::endl;
+        return;
+    }
+    ThreadPool pool;
+
+    auto report = [](const std::string& label, const std::function<void()>& load) {
+        std::size_t before = allocationCount();
+        auto start = std::chrono::high_resolution_clock::now();
+        load();
+        auto stop = std::chrono::high_resolution_clock::now();
+        std::cout << "  " << label << ": " << allocationCount() - before << " allocations, "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() / 1000.0
+                  << " Milliseconds" << std::endl;
+    };
+
+    report("Legacy getline", [&]() {
+        HouseMap houseData;
+        OccupationMap occupationData;
+        std::map<std::string, std::string> occupationNames;
+        legacyLoadHouseData(housePath, houseData);
+        legacyLoadOccupationData(occupationPath, occupationData, occupationNames);
+    });
+    report("Chunked, heap-backed maps", [&]() {
+        HouseMap houseData;
+        OccupationMap occupationData;
+        std::set<std::string_view> occupationNames;
+        loadDataFiles(housePath, occupationPath, houseData, occupationData, occupationNames, pool);
+    });
+    std::size_t blocks = 0, bytes = 0;
+    report("Chunked, Dataset arenas", [&]() {
+        Dataset dataset;
+        dataset.load(housePath, occupationPath, pool);
+        blocks = dataset.arenaBlocks();
+        bytes = dataset.arenaBytes();
+    });
+    std::cout << "  Dataset arenas: " << blocks << " blocks, " << bytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+}
+
+// Memory held by the loaded state: the single Dataset, against the Dataset plus the
+// unsortedHouseData/unsortedOccupationData copies main() used to keep for the sort timings.
+// The copies are made through a counting resource, so their bytes are measured rather than assumed.
+void benchLoadedState(const std::string& housePath, const std::string& occupationPath) {
+    std::cout << "Loaded state memory" << std::endl;
+    ThreadPool pool;
+    std::size_t baseline = residentBytes();
+    Dataset dataset;
+    dataset.load(housePath, occupationPath, pool);
+    std::size_t loaded = residentBytes();
+
+    printMegabytes("Dataset record arenas", dataset.arenaBytes());
+    printMegabytes("Dataset columnar tables", dataset.houseTable.memoryBytes() + dataset.occupationTable.memoryBytes());
+    printMegabytes("Dataset total", dataset.memoryBytes());
+
+    CountingResource copies;
+    HouseMap unsortedHouseData(dataset.houseData, &copies);
+    OccupationMap unsortedOccupationData(dataset.occupationData, &copies);
+    std::size_t withCopies = residentBytes();
+    printMegabytes("Unsorted copies", copies.bytes());
+    printMegabytes("Dataset total + unsorted copies", dataset.memoryBytes() + copies.bytes());
+    if (baseline > 0) {
+        printMegabytes("Resident growth, Dataset only", loaded - baseline);
+        printMegabytes("Resident growth, Dataset + unsorted copies", withCopies - baseline);
+    }
+}
+
+// Concurrent chunked load of both files at 1, 2, 4, ... threads up to the hardware thread count
+void benchParallelLoad(const std::string& housePath, const std::string& occupationPath) {
+    std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Parallel load of both files (" << hardware << " hardware threads)" << std::endl;
+
+    double single = 0.0;
+    for (std::size_t threads = 1; ; threads = std::min(threads * 2, hardware)) {
+        ThreadPool pool(threads);
+        double best = timeRuns(std::to_string(threads) + " threads", [&]() {
+            HouseMap houseData;
+            OccupationMap occupationData;
+            std::set<std::string_view> occupationNames;
+            loadDataFiles(housePath, occupationPath, houseData, occupationData, occupationNames, pool);
+        });
+        if (threads == 1) {
+            single = best;
+        }
+        std::cout << "  " << threads << " threads speedup: " << (best > 0 ? single / best : 0.0) << "x" << std::endl;
+        if (threads == hardware) {
+            break;
+        }
+    }
+}
+
+// Structural scan alone at every level the CPU supports, against the getline(iss, field, ',') chain
+void benchScanner(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "  " << path << " not found, skipping scanner" << std::endl;
+        return;
+    }
+    const std::size_t bytes = file.size();
+    std::cout << "Structural scan of " << path << " (" << bytes << " bytes)" << std::endl;
+
+    std::vector<std::uint32_t> offsets;
+    offsets.reserve(64 * 1024);
+    std::size_t found = 0;
+    int topLevel = static_cast<int>(detectScanLevel());
+    for (int levelIndex = 0; levelIndex <= topLevel; levelIndex++) {
+        ScanLevel level = static_cast<ScanLevel>(levelIndex);
+        double best = timeRuns(std::string(scanLevelName(level)) + " scan", [&]() {
+            bool inQuotes = false;
+            found = 0;
+            for (std::size_t pos = 0; pos < bytes; pos += 64 * 1024) {
+                offsets.clear();
+                scanStructural(level, file.begin() + pos, std::min<std::size_t>(64 * 1024, bytes - pos), inQuotes, offsets);
+                found += offsets.size();
+            }
+        });
+        printThroughput(std::string(scanLevelName(level)) + " scan", bytes, best);
+    }
+    std::cout << "  Structural characters found: " << found << std::endl;
+
+    // Full tokenization through CsvReader; the file is remapped per run since unquoting edits the mapping
+    std::size_t fieldCount = 0;
+    double best = timeRuns("CsvReader map + tokenize", [&]() {
+        MappedFile copy;
+        copy.open(path);
+        CsvReader reader(copy.begin(), copy.end());
+        std::vector<std::string_view> fields;
+        fieldCount = 0;
+        while (reader.nextRow(fields)) {
+            fieldCount += fields.size();
+        }
+    });
+    printThroughput("CsvReader map + tokenize", bytes, best);
+
+    const std::string contents(file.begin(), file.end());
+    std::size_t legacyCount = 0;
+    best = timeRuns("getline(iss, field, ',') chain", [&]() {
+        std::istringstream input(contents);
+        std::string line, field;
+        legacyCount = 0;
+        while (std::getline(input, line)) {
+            std::istringstream iss(line);
+            while (std::getline(iss, field, ',')) {
+                legacyCount++;
+            }
+        }
+    });
+    printThroughput("getline(iss, field, ',') chain", bytes, best);
+    std::cout << "  Fields: CsvReader " << fieldCount << ", getline chain " << legacyCount << std::endl;
+}
+
+
+// Parse throughput of the numeric columns: isdigit + std::stod against parseNumber
+void benchNumberParse(const std::string& path, const std::vector<std::size_t>& columns) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "  " << path << " not found, skipping number parsing" << std::endl;
+        return;
+    }
+    std::vector<std::string> values;
+    std::size_t bytes = 0;
+    CsvReader reader(file.begin(), file.end());
+    std::vector<std::string_view> fields;
+    reader.nextRow(fields);
+    while (reader.nextRow(fields)) {
+        for (std::size_t column : columns) {
+            if (column < fields.size()) {
+                values.emplace_back(fields[column]);
+                bytes += fields[column].size();
+            }
+        }
+    }
+    std::cout << "Number parsing of " << path << " (" << values.size() << " values)" << std::endl;
+
+    double sum = 0.0;
+    double best = timeRuns("isdigit + std::stod", [&]() {
+        for (const std::string& value : values) {
+            sum += (!value.empty() && isdigit(value[0])) ? std::stod(value) : 0.0;
+        }
+    });
+    printThroughput("isdigit + std::stod", bytes, best);
+    std::cout << "  isdigit + std::stod values/s: " << values.size() / (best / 1000.0) << std::endl;
+
+    std::size_t missing = 0;
+    best = timeRuns("parseNumber", [&]() {
+        missing = 0;
+        for (const std::string& value : values) {
+            std::optional<double> parsed = parseNumber(value);
+            if (parsed) {
+                sum += *parsed;
+            } else {
+                missing++;
+            }
+        }
+    });
+    printThroughput("parseNumber", bytes, best);
+    std::cout << "  parseNumber values/s: " << values.size() / (best / 1000.0) << std::endl;
+    std::cout << "  Missing or suppressed values: " << missing << " (checksum " << sum << ")" << std::endl;
+}
+
+
+// Footprint and per-state sort cost of the record maps against the columnar tables
+void benchColumnTables(const std::string& housePath, const std::string& occupationPath) {
+    HouseMap houseData;
+    OccupationMap occupationData;
+    std::set<std::string_view> occupationNames;
+    loadHouseData(housePath, houseData);
+    loadOccupationData(occupationPath, occupationData, occupationNames);
+
+    HouseTable houseTable = buildHouseTable(houseData);
+    OccupationTable occupationTable = buildOccupationTable(occupationData);
+
+    std::cout << "Memory footprint (records " << sizeof(HouseInfo) << " / " << sizeof(Occupation) << " bytes each)" << std::endl;
+    printMegabytes("HouseInfo records", recordMemoryBytes(houseData));
+    printMegabytes("HouseTable columns", houseTable.memoryBytes());
+    printMegabytes("Occupation records", recordMemoryBytes(occupationData));
+    printMegabytes("OccupationTable columns", occupationTable.memoryBytes());
+    std::cout << "  Interned strings: " << stringPool().size() << std::endl;
+    printMegabytes("String pool", stringPool().memoryBytes());
+
+    // Row lists of each state in load order, so the permutation sorts start from the same order as the records
+    std::vector<std::vector<std::uint32_t>> houseRows(houseTable.states.size());
+    for (std::uint32_t row = 0; row < houseTable.rows(); row++) {
+        houseRows[houseTable.State[row]].push_back(row);
+    }
+    std::vector<std::vector<std::uint32_t>> occupationRows(occupationTable.states.size());
+    for (std::uint32_t row = 0; row < occupationTable.rows(); row++) {
+        occupationRows[occupationTable.PRIM_STATE[row]].push_back(row);
+    }
+
+    std::cout << "Per-state sort by value (each run sorts a fresh copy)" << std::endl;
+    timeRuns("Copy + sort of HouseInfo records", [&]() {
+        HouseMap copy = houseData;
+        for (auto& entry : copy) {
+            std::sort(entry.second.begin(), entry.second.end());
+        }
+    });
+    timeRuns("Copy + sort of HouseTable row permutations", [&]() {
+        std::vector<std::vector<std::uint32_t>> rows = houseRows;
+        for (auto& stateRows : rows) {
+            sortRowsByColumn(houseTable.MeanValue, stateRows);
+        }
+    });
+    timeRuns("Copy + sort of Occupation records", [&]() {
+        OccupationMap copy = occupationData;
+        for (auto& entry : copy) {
+            std::sort(entry.second.begin(), entry.second.end());
+        }
+    });
+    timeRuns("Copy + sort of OccupationTable row permutations", [&]() {
+        std::vector<std::vector<std::uint32_t>> rows = occupationRows;
+        for (auto& stateRows : rows) {
+            sortRowsByColumn(occupationTable.A_MEAN, stateRows);
+        }
+    });
+}
+
+
+// Per-query latency against the shared dataset, and with the deep copy the old by-value
+// searchOccupations/top5States parameters made on every call
+void benchQueryLatency(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset || dataset->occupationNames.empty()) {
+        std::cout << "Query latency skipped, no occupation data" << std::endl;
+        return;
+    }
+    std::vector<std::string> titles;
+    for (std::string_view title : dataset->occupationNames) {
+        if (titles.size() == 20) {
+            break;
+        }
+        titles.emplace_back(title);
+    }
+    std::cout << "Query latency over " << titles.size() << " titles (search + top5States)" << std::endl;
+
+    std::ostringstream sink;
+    double best = timeRuns("With per-query dataset copy", [&]() {
+        for (const std::string& title : titles) {
+            OccupationMap searchCopy = dataset->occupationData;
+            OccupationMap rankCopy = dataset->occupationData;
+            searchOccupations(*dataset, title.substr(0, 4));
+            top5States(title, 5, *dataset, sink);
+        }
+    });
+    std::cout << "  With per-query dataset copy, per query: " << best * 1000.0 / titles.size() << " Microseconds" << std::endl;
+    best = timeRuns("Shared const dataset", [&]() {
+        for (const std::string& title : titles) {
+            searchOccupations(*dataset, title.substr(0, 4));
+            top5States(title, 5, *dataset, sink);
+        }
+    });
+    std::cout << "  Shared const dataset, per query: " << best * 1000.0 / titles.size() << " Microseconds" << std::endl;
+}
+
+
+// Synthetic salary records with A_MEAN laid out as one of the sort benchmark patterns
+std::vector<Occupation> makeOccupations(std::size_t count, const std::string& pattern) {
+    std::mt19937_64 random(42);
+    std::vector<Occupation> records;
+    records.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        double key = 0.0;
+        if (pattern == "random") {
+            key = static_cast<double>(random() % 1000000000) / 100.0;
+        } else if (pattern == "sorted") {
+            key = static_cast<double>(i);
+        } else if (pattern == "reversed") {
+            key = static_cast<double>(count - i);
+        } else {
+            key = static_cast<double>(random() % 16) * 1000.0;
+        }
+        records.emplace_back(0, 0, 0, 0.0, key);
+    }
+    return records;
+}
+
+// The introsort quickSort against std::sort on random, sorted, reversed and many-duplicate keys
+void benchSortEngine() {
+    const std::size_t count = 1000000;
+    std::cout << "Sort engine on " << count << " Occupation records" << std::endl;
+    for (const std::string pattern : {"random", "sorted", "reversed", "duplicates"}) {
+        const std::vector<Occupation> input = makeOccupations(count, pattern);
+        std::vector<Occupation> scratch;
+        timeRuns(pattern + " quickSort", [&]() {
+            scratch = input;
+            quickSort(scratch.begin(), scratch.end());
+        });
+        timeRuns(pattern + " std::sort", [&]() {
+            scratch = input;
+            std::sort(scratch.begin(), scratch.end());
+        });
+    }
+}
+
+// One row of the shell sort matrix: counted pass for comparisons and moves, uncounted pass for time
+template <typename GapPolicy, typename T>
+void shellSortRow(const std::string& dataName, const StateMap<T>& data) {
+    SortCounts counts;
+    StateMap<T> scratch = data;
+    for (auto& entry : scratch) {
+        shellSort<GapPolicy>(entry.second.begin(), entry.second.end(), std::less<>(), counts);
+    }
+    double best = timeRuns(dataName + " " + GapPolicy::name, [&]() {
+        scratch = data;
+        for (auto& entry : scratch) {
+            shellSort<GapPolicy>(entry.second.begin(), entry.second.end(), std::less<>());
+        }
+    });
+    std::cout << "  " << dataName << " " << GapPolicy::name << ": " << counts.comparisons << " comparisons, "
+              << counts.moves << " moves, " << best << " Milliseconds (includes copy)" << std::endl;
+}
+
+template <typename T>
+void shellSortMatrix(const std::string& dataName, const StateMap<T>& data) {
+    shellSortRow<ShellGaps>(dataName, data);
+    shellSortRow<KnuthGaps>(dataName, data);
+    shellSortRow<SedgewickGaps>(dataName, data);
+    shellSortRow<CiuraGaps>(dataName, data);
+    shellSortRow<TokudaGaps>(dataName, data);
+}
+
+// Every gap sequence over every per-state vector of both datasets
+void benchShellGaps(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset) {
+        return;
+    }
+    std::cout << "Shell sort gap sequences over all per-state vectors" << std::endl;
+    shellSortMatrix("houseData", dataset->houseData);
+    shellSortMatrix("occupationData", dataset->occupationData);
+}
+
+
+// Per-state sorts of one dataset, sequential and then on pools of 1, 2, 4, ... threads
+template <typename T>
+void parallelSortScaling(const std::string& dataName, const StateMap<T>& data) {
+    std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    auto shellOne = [](std::pmr::vector<T>& dataSet) {
+        shellSort<CiuraGaps>(dataSet.begin(), dataSet.end(), std::less<>());
+    };
+    auto quickOne = [](std::pmr::vector<T>& dataSet) {
+        quickSort(dataSet.begin(), dataSet.end());
+    };
+
+    StateMap<T> scratch;
+    double shellBase = timeRuns(dataName + " sequential shell", [&]() {
+        scratch = data;
+        for (auto& entry : scratch) {
+            shellOne(entry.second);
+        }
+    });
+    double quickBase = timeRuns(dataName + " sequential quick", [&]() {
+        scratch = data;
+        for (auto& entry : scratch) {
+            quickOne(entry.second);
+        }
+    });
+    for (std::size_t threads = 1; ; threads = std::min(threads * 2, hardware)) {
+        ThreadPool pool(threads);
+        double shellBest = timeRuns(dataName + " shell " + std::to_string(threads) + " threads", [&]() {
+            scratch = data;
+            sortStatesParallel(scratch, pool, shellOne);
+        });
+        double quickBest = timeRuns(dataName + " quick " + std::to_string(threads) + " threads", [&]() {
+            scratch = data;
+            sortStatesParallel(scratch, pool, quickOne);
+        });
+        std::cout << "  " << dataName << " " << threads << " threads speedup: shell "
+                  << (shellBest > 0 ? shellBase / shellBest : 0.0) << "x, quick "
+                  << (quickBest > 0 ? quickBase / quickBest : 0.0) << "x, " << pool.stealCount() << " steals"
+                  << std::endl;
+        if (threads == hardware) {
+            break;
+        }
+    }
+}
+
+// Thread scaling of the parallel per-state sort drivers on both datasets (times include the copy)
+void benchParallelSort(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool loadPool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, loadPool);
+    if (!dataset) {
+        return;
+    }
+    std::cout << "Parallel per-state sorting, largest states first" << std::endl;
+    parallelSortScaling("houseData", dataset->houseData);
+    parallelSortScaling("occupationData", dataset->occupationData);
+}
+
+
+// parallelQuickSort on one synthetic 10M-row state against the sequential quickSort
+void benchLargeStateSort() {
+    const std::size_t count = 10000000;
+    std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Single state of " << count << " Occupation records" << std::endl;
+    const std::vector<Occupation> input = makeOccupations(count, "random");
+    std::vector<Occupation> scratch;
+    double sequential = timeRuns("sequential quickSort", [&]() {
+        scratch = input;
+        quickSort(scratch.begin(), scratch.end());
+    });
+    for (std::size_t threads = 2; ; threads = std::min(threads * 2, std::max<std::size_t>(hardware, 2))) {
+        ThreadPool pool(threads);
+        double best = timeRuns("parallelQuickSort " + std::to_string(threads) + " threads", [&]() {
+            scratch = input;
+            parallelQuickSort(scratch.begin(), scratch.end(), pool);
+        });
+        std::cout << "  " << threads << " threads speedup: " << (best > 0 ? sequential / best : 0.0) << "x, "
+                  << pool.stealCount() << " steals" << std::endl;
+        if (threads >= hardware) {
+            break;
+        }
+    }
+}
+
+
+// Radix sort by extracted key against the comparison sorts, on the loaded per-state vectors and on
+// a synthetic 1M-row vector with negative values and missing (NaN) values mixed in
+void benchRadixSort(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset) {
+        return;
+    }
+    std::cout << "Radix sort on extracted keys" << std::endl;
+    OccupationMap scratch;
+    timeRuns("occupationData quickSort", [&]() {
+        scratch = dataset->occupationData;
+        for (auto& entry : scratch) {
+            quickSort(entry.second.begin(), entry.second.end());
+        }
+    });
+    timeRuns("occupationData radixSort", [&]() {
+        scratch = dataset->occupationData;
+        for (auto& entry : scratch) {
+            radixSort(entry.second);
+        }
+    });
+
+    const std::size_t count = 1000000;
+    std::vector<Occupation> input = makeOccupations(count, "random");
+    std::mt19937_64 random(7);
+    for (std::size_t i = 0; i < count; i++) {
+        // TOT_EMP tags the input position so the stability check below can see it
+        Occupation& record = input[i];
+        record.TOT_EMP = static_cast<double>(i);
+        std::uint64_t roll = random() % 100;
+        if (roll < 5) {
+            record.A_MEAN = missingValue;
+        } else if (roll < 15) {
+            record.A_MEAN = -record.A_MEAN;
+        }
+    }
+    std::pmr::vector<Occupation> records;
+    timeRuns("1M mixed quickSort", [&]() {
+        records.assign(input.begin(), input.end());
+        quickSort(records.begin(), records.end());
+    });
+    timeRuns("1M mixed std::stable_sort", [&]() {
+        records.assign(input.begin(), input.end());
+        std::stable_sort(records.begin(), records.end());
+    });
+    std::vector<double> keys;
+    for (const Occupation& record : input) {
+        keys.push_back(record.A_MEAN);
+    }
+    std::vector<std::uint32_t> order;
+    timeRuns("1M mixed radix permutation only", [&]() {
+        radixSortPermutation(keys.data(), keys.size(), order);
+    });
+    timeRuns("1M mixed radixSort", [&]() {
+        records.assign(input.begin(), input.end());
+        radixSort(records);
+    });
+
+    // Radix sort is stable, so it must agree with stable_sort record for record
+    std::vector<Occupation> expected = input;
+    std::stable_sort(expected.begin(), expected.end());
+    bool same = true;
+    for (std::size_t i = 0; i < count && same; i++) {
+        same = radixKey(records[i].A_MEAN) == radixKey(expected[i].A_MEAN) && records[i].TOT_EMP == expected[i].TOT_EMP;
+    }
+    std::cout << "  radixSort matches std::stable_sort: " << (same ? "yes" : "NO") << std::endl;
+}
+
+
+// Element wrapper that counts every move construction and move assignment the sorts perform
+std::size_t elementMoves = 0;
+
+template <typename T>
+struct MoveCounted {
+    T value;
+
+    explicit MoveCounted(const T& value) : value(value) {}
+    MoveCounted(MoveCounted&& other) noexcept : value(std::move(other.value)) { elementMoves++; }
+    MoveCounted& operator=(MoveCounted&& other) noexcept {
+        value = std::move(other.value);
+        elementMoves++;
+        return *this;
+    }
+};
+
+// Bytes moved by quickSort and by shell sort over elements of type T, summed over every state
+template <typename T, typename Less>
+void printBytesMoved(const std::string& label, const std::vector<std::vector<T>>& states, Less less) {
+    auto countedLess = [&](const MoveCounted<T>& a, const MoveCounted<T>& b) { return less(a.value, b.value); };
+    std::size_t quickMoves = 0, shellMoves = 0;
+    for (const std::vector<T>& state : states) {
+        std::vector<MoveCounted<T>> counted(state.begin(), state.end());
+        elementMoves = 0;
+        quickSort(counted.begin(), counted.end(), countedLess);
+        quickMoves += elementMoves;
+
+        counted = std::vector<MoveCounted<T>>(state.begin(), state.end());
+        elementMoves = 0;
+        shellSort<CiuraGaps>(counted.begin(), counted.end(), countedLess);
+        shellMoves += elementMoves;
+    }
+    std::cout << "  " << label << " (" << sizeof(T) << " byte elements): quickSort moves "
+              << quickMoves * sizeof(T) / (1024.0 * 1024.0) << " MiB, shell sort moves "
+              << shellMoves * sizeof(T) / (1024.0 * 1024.0) << " MiB" << std::endl;
+}
+
+// Sorting the records themselves against sorting (key, index) pairs into a permutation
+template <typename T>
+void indexSortComparison(const std::string& dataName, const StateMap<T>& data) {
+    std::vector<std::vector<T>> records;
+    std::vector<std::vector<KeyedIndex>> keyed;
+    for (const auto& entry : data) {
+        records.emplace_back(entry.second.begin(), entry.second.end());
+        keyed.push_back(keyedIndices(entry.second, [](const T& record) { return sortKey(record); }));
+    }
+    printBytesMoved(dataName + " records", records, std::less<>());
+    printBytesMoved(dataName + " key+index", keyed, keyedIndexLess);
+
+    StateMap<T> scratch;
+    timeRuns(dataName + " copy + quickSort records", [&]() {
+        scratch = data;
+        for (auto& entry : scratch) {
+            quickSort(entry.second.begin(), entry.second.end());
+        }
+    });
+    std::vector<Permutation> orders(data.size());
+    timeRuns(dataName + " quickSortPermutation", [&]() {
+        std::size_t i = 0;
+        for (const auto& entry : data) {
+            orders[i++] = quickSortPermutation(entry.second);
+        }
+    });
+    timeRuns(dataName + " copy + shell sort records", [&]() {
+        scratch = data;
+        for (auto& entry : scratch) {
+            shellSort<CiuraGaps>(entry.second.begin(), entry.second.end(), std::less<>());
+        }
+    });
+    timeRuns(dataName + " shellSortPermutation", [&]() {
+        std::size_t i = 0;
+        for (const auto& entry : data) {
+            orders[i++] = shellSortPermutation(entry.second);
+        }
+    });
+    std::size_t materialized = 0;
+    timeRuns(dataName + " materialize every state", [&]() {
+        std::size_t i = 0;
+        for (const auto& entry : data) {
+            std::pmr::vector<T> sorted = materialize(entry.second, orders[i++]);
+            materialized += sorted.size();
+        }
+    });
+    std::cout << "  " << dataName << " materialized " << materialized / benchRuns << " records per run" << std::endl;
+}
+
+// Sort-by-index mode on both datasets: bytes moved inside the sorts and wall time
+void benchIndexSort(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset) {
+        return;
+    }
+    std::cout << "Sort by index versus sorting records" << std::endl;
+    indexSortComparison("houseData", dataset->houseData);
+    indexSortComparison("occupationData", dataset->occupationData);
+}
+
+
+// County-level rankings at k = 5, 50 and 500: whole query latency, then the selection step alone
+// (heap topKHeap, nth_element topKSelect, topK choosing between them, and a full sort) over the same county scores
+void benchTopK(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset || dataset->occupationNames.empty()) {
+        std::cout << "Top-k skipped, no occupation data" << std::endl;
+        return;
+    }
+    const std::string title(*dataset->occupationNames.begin());
+    std::size_t places = rankPlaces(title, dataset->houseTable.rows(), Granularity::County, *dataset).size();
+    std::cout << "Top-k over " << places << " counties for " << title << std::endl;
+
+    std::mt19937_64 random(3);
+    std::vector<double> scores(places);
+    for (double& score : scores) {
+        score = static_cast<double>(random() % 1000000);
+    }
+    auto byValue = [](double score) { return score; };
+    for (std::size_t k : {5, 50, 500}) {
+        const std::string label = "k=" + std::to_string(k);
+        timeRuns(label + " rankPlaces by county", [&]() {
+            rankPlaces(title, k, Granularity::County, *dataset);
+        });
+        timeRuns(label + " heap topKHeap x100", [&]() {
+            for (int i = 0; i < 100; i++) {
+                topKHeap(scores.begin(), scores.end(), k, byValue);
+            }
+        });
+        timeRuns(label + " nth_element topKSelect x100", [&]() {
+            for (int i = 0; i < 100; i++) {
+                topKSelect(scores.begin(), scores.end(), k, byValue);
+            }
+        });
+        timeRuns(label + " topK (picks one) x100", [&]() {
+            for (int i = 0; i < 100; i++) {
+                topK(scores.begin(), scores.end(), k, byValue);
+            }
+        });
+        timeRuns(label + " full sort x100", [&]() {
+            for (int i = 0; i < 100; i++) {
+                std::vector<double> sorted = scores;
+                std::sort(sorted.begin(), sorted.end(), std::greater<>());
+            }
+        });
+    }
+}
+
+
+// Salary side of a query as it was before the salary index: a scan of the title and salary columns
+std::vector<double> scanSalaryByState(StringId title, const OccupationTable& occupationTable) {
+    std::vector<double> salaryTotal(occupationTable.states.size(), 0.0);
+    std::vector<std::uint32_t> salaryCount(occupationTable.states.size(), 0);
+    for (std::size_t row = 0; row < occupationTable.rows(); row++) {
+        if (occupationTable.OCC_TITLE[row] == title && !isMissing(occupationTable.A_MEAN[row])) {
+            salaryTotal[occupationTable.PRIM_STATE[row]] += occupationTable.A_MEAN[row];
+            salaryCount[occupationTable.PRIM_STATE[row]]++;
+        }
+    }
+    for (std::size_t state = 0; state < salaryTotal.size(); state++) {
+        salaryTotal[state] = salaryCount[state] != 0 ? salaryTotal[state] / salaryCount[state] : 0.0;
+    }
+    return salaryTotal;
+}
+
+// Every occupation in sequence: the salary side by column scan against the salary index lookup,
+// then the whole top5States query
+void benchSalaryIndex(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset || dataset->occupationNames.empty()) {
+        std::cout << "Salary index skipped, no occupation data" << std::endl;
+        return;
+    }
+    std::vector<StringId> titles;
+    for (std::string_view title : dataset->occupationNames) {
+        titles.push_back(*stringPool().find(title));
+    }
+    std::cout << "Salary aggregates for all " << titles.size() << " occupations ("
+              << dataset->salaryIndex.memoryBytes() / 1024 << " KiB index)" << std::endl;
+
+    double checksum = 0.0;
+    double scan = timeRuns("Column scan per title", [&]() {
+        for (StringId title : titles) {
+            checksum += scanSalaryByState(title, dataset->occupationTable)[0];
+        }
+    });
+    double lookup = timeRuns("Salary index per title", [&]() {
+        for (StringId title : titles) {
+            const SalaryAggregate* aggregates = dataset->salaryIndex.find(title);
+            std::vector<double> means(dataset->salaryIndex.states());
+            for (std::size_t state = 0; state < means.size(); state++) {
+                means[state] = aggregates ? aggregates[state].mean() : 0.0;
+            }
+            checksum += means[0];
+        }
+    });
+    std::cout << "  Per title: scan " << scan * 1000.0 / titles.size() << " Microseconds, index "
+              << lookup * 1000.0 / titles.size() << " Microseconds (checksum " << checksum << ")" << std::endl;
+
+    std::ostringstream sink;
+    double whole = timeRuns("top5States for every title", [&]() {
+        for (std::string_view title : dataset->occupationNames) {
+            top5States(std::string(title), 5, *dataset, sink);
+        }
+    });
+    std::cout << "  top5States per title: " << whole * 1000.0 / titles.size() << " Microseconds" << std::endl;
+}
+
+
+// Home value side of a query as it was before the cached statistics: a whole-number total per state,
+// truncated after every addition as the old int total was, every query. The total is 64-bit, since a
+// large state's home values overflow an int.
+std::vector<float> recomputeHomeValueByState(const HouseTable& houseTable) {
+    std::vector<std::int64_t> totals(houseTable.states.size(), 0);
+    std::vector<int> counters(houseTable.states.size(), 0);
+    for (std::size_t row = 0; row < houseTable.rows(); row++) {
+        if (isMissing(houseTable.MeanValue[row])) {
+            continue;
+        }
+        std::int64_t& total = totals[houseTable.State[row]];
+        total = static_cast<std::int64_t>(static_cast<double>(total) + houseTable.MeanValue[row]);
+        counters[houseTable.State[row]] += 1;
+    }
+    std::vector<float> means(houseTable.states.size(), 0);
+    for (std::uint32_t state = 0; state < means.size(); state++) {
+        means[state] = (counters[state] != 0) ? static_cast<float>(totals[state]) / counters[state] : 0;
+    }
+    return means;
+}
+
+// Cost of building the home value statistics once, per-query recomputation against reading them,
+// and how far the old int accumulation drifted from the compensated mean
+void benchHomeStats(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset) {
+        return;
+    }
+    const HouseTable& houseTable = dataset->houseTable;
+    const HomeValueStats& homeStats = dataset->homeStats;
+    std::cout << "Home value statistics: " << homeStats.byState.size() << " states, " << homeStats.byCounty.size()
+              << " counties, " << homeStats.byCity.size() << " cities" << std::endl;
+    timeRuns("Build at load", [&]() {
+        buildHomeValueStats(houseTable);
+    });
+
+    const int queries = 1000;
+    double checksum = 0.0;
+    double recompute = timeRuns("Recompute per query x" + std::to_string(queries), [&]() {
+        for (int i = 0; i < queries; i++) {
+            checksum += recomputeHomeValueByState(houseTable)[0];
+        }
+    });
+    double cached = timeRuns("Cached per query x" + std::to_string(queries), [&]() {
+        for (int i = 0; i < queries; i++) {
+            std::vector<float> means(homeStats.byState.size());
+            for (std::size_t state = 0; state < means.size(); state++) {
+                means[state] = static_cast<float>(homeStats.byState[state].mean);
+            }
+            checksum += means[0];
+        }
+    });
+    std::cout << "  Per query: recompute " << recompute * 1000.0 / queries << " Microseconds, cached "
+              << cached * 1000.0 / queries << " Microseconds (checksum " << checksum << ")" << std::endl;
+
+    std::vector<float> truncated = recomputeHomeValueByState(houseTable);
+    double worst = 0.0;
+    std::size_t worstState = 0;
+    for (std::size_t state = 0; state < truncated.size(); state++) {
+        double drift = std::abs(truncated[state] - homeStats.byState[state].mean);
+        if (homeStats.byState[state].count != 0 && drift >= worst) {
+            worst = drift;
+            worstState = state;
+        }
+    }
+    const ValueStats& stats = homeStats.byState[worstState];
+    std::cout << "  Largest int-total drift: " << houseTable.states.str(worstState) << " mean " << truncated[worstState]
+              << " vs " << stats.mean << " (" << stats.count << " homes, median " << stats.median << ", p10 "
+              << stats.p10 << ", p90 " << stats.p90 << ")" << std::endl;
+}
+
+
+// The original search: every record of every state, matching titles that start with keyword
+std::set<std::string> scanOccupations(const Dataset& dataset, const std::string& keyword) {
+    std::set<std::string> matchingTitles;
+    for (const auto& state : dataset.occupationData) {
+        for (const Occupation& occupation : state.second) {
+            std::string_view title = stringPool().str(occupation.OCC_TITLE);
+            if (title.find(keyword) == 0) {
+                matchingTitles.emplace(title);
+            }
+        }
+    }
+    return matchingTitles;
+}
+
+// Keyword search latency over a fixed keyword list: record scan against the title index
+void benchTitleSearch(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset || dataset->occupationNames.empty()) {
+        std::cout << "Title search skipped, no occupation data" << std::endl;
+        return;
+    }
+    const std::vector<std::string> keywords = {"Nurse", "nurse", "Software", "Manag", "Teach", "Chief", "Truck",
+                                               "Account", "Engineer", "a", "Comp", "Office", "Xyz", "Police"};
+    std::cout << "Title search over " << dataset->titleIndex.size() << " titles, " << keywords.size()
+              << " keywords (" << dataset->titleIndex.memoryBytes() / 1024 << " KiB index)" << std::endl;
+    timeRuns("Build at load", [&]() {
+        buildTitleIndex(dataset->occupationNames);
+    });
+
+    std::size_t scanned = 0, indexed = 0;
+    double scan = timeRuns("Record scan", [&]() {
+        for (const std::string& keyword : keywords) {
+            scanned += scanOccupations(*dataset, keyword).size();
+        }
+    });
+    double index = timeRuns("Title index", [&]() {
+        for (const std::string& keyword : keywords) {
+            indexed += searchOccupations(*dataset, keyword).size();
+        }
+    });
+    std::cout << "  Per keyword: scan " << scan * 1000.0 / keywords.size() << " Microseconds ("
+              << scanned / benchRuns << " matches), index " << index * 1000.0 / keywords.size()
+              << " Microseconds (" << indexed / benchRuns << " matches)" << std::endl;
+}
+
+
+// Applies one random edit (drop, swap with the next, replace or insert a letter) to the longest word of title
+std::string withTypo(const std::string& title, std::mt19937_64& random) {
+    std::size_t bestStart = 0, bestLength = 0, start = 0;
+    for (std::size_t i = 0; i <= title.size(); i++) {
+        if (i == title.size() || title[i] == ' ' || title[i] == ',') {
+            if (i - start > bestLength) {
+                bestStart = start;
+                bestLength = i - start;
+            }
+            start = i + 1;
+        }
+    }
+    std::string typo = title;
+    if (bestLength < 4) {
+        return typo;
+    }
+    // Keep the first letter, as most typos do
+    std::size_t at = bestStart + 1 + random() % (bestLength - 2);
+    char letter = static_cast<char>('a' + random() % 26);
+    switch (random() % 4) {
+        case 0:
+            typo.erase(at, 1);
+            break;
+        case 1:
+            std::swap(typo[at], typo[at + 1]);
+            break;
+        case 2:
+            typo[at] = letter;
+            break;
+        default:
+            typo.insert(typo.begin() + static_cast<std::ptrdiff_t>(at), letter);
+            break;
+    }
+    return typo;
+}
+
+// Fuzzy title matching: recall of the intended title among the top 1 and top 10 results for every
+// title with one typo, latency per query, and a few hand-written misspellings
+void benchFuzzySearch(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset || dataset->occupationNames.empty()) {
+        std::cout << "Fuzzy search skipped, no occupation data" << std::endl;
+        return;
+    }
+    const TitleIndex& index = dataset->titleIndex;
+    std::mt19937_64 random(11);
+    std::vector<std::string> queries;
+    for (std::uint32_t id = 0; id < index.size(); id++) {
+        queries.push_back(withTypo(std::string(index.title(id)), random));
+    }
+    std::cout << "Fuzzy search over " << index.size() << " titles, one typo per query" << std::endl;
+
+    std::size_t top1 = 0, top10 = 0;
+    for (std::uint32_t id = 0; id < queries.size(); id++) {
+        std::vector<TitleMatch> matches = index.fuzzyMatch(queries[id], 10);
+        for (std::size_t rank = 0; rank < matches.size(); rank++) {
+            if (matches[rank].id == id) {
+                top1 += rank == 0;
+                top10++;
+                break;
+            }
+        }
+    }
+    std::cout << "  Recall@1: " << 100.0 * top1 / queries.size() << "%, Recall@10: "
+              << 100.0 * top10 / queries.size() << "%" << std::endl;
+    double best = timeRuns("fuzzyMatch all queries", [&]() {
+        for (const std::string& query : queries) {
+            index.fuzzyMatch(query, 10);
+        }
+    });
+    std::cout << "  Per query: " << best * 1000.0 / queries.size() << " Microseconds" << std::endl;
+
+    for (const std::string query : {"softwre", "Nurses", "nurse", "acountant", "polise", "truk drivers"}) {
+        std::vector<std::string> found = searchOccupations(*dataset, query);
+        std::cout << "  \"" << query << "\" -> " << (found.empty() ? std::string("(nothing)") : found.front())
+                  << (found.size() > 1 ? " and " + std::to_string(found.size() - 1) + " more" : "") << std::endl;
+    }
+}
+
+
+// Same rankings for every title from both datasets
+bool sameRankings(const Dataset& a, const Dataset& b) {
+    if (a.occupationNames != b.occupationNames) {
+        return false;
+    }
+    for (std::string_view title : a.occupationNames) {
+        std::ostringstream first, second;
+        top5States(std::string(title), 10, a, first);
+        top5States(std::string(title), 10, b, second);
+        topCounties(std::string(title), 10, a, first);
+        topCounties(std::string(title), 10, b, second);
+        if (first.str() != second.str()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Startup from the CSVs against startup from a snapshot, plus the cases that must invalidate it
+void benchSnapshot(const std::string& housePath, const std::string& occupationPath) {
+    namespace fs = std::filesystem;
+    const fs::path directory = fs::temp_directory_path() / "project3-snapshot-bench";
+    fs::create_directories(directory);
+    const std::string house = (directory / "PropertyValues.csv").string();
+    const std::string occupation = (directory / "JobSalarys.csv").string();
+    const std::string snapshot = (directory / "Project3.snapshot").string();
+    fs::copy_file(housePath, house, fs::copy_options::overwrite_existing);
+    if (fileExists(occupationPath)) {
+        fs::copy_file(occupationPath, occupation, fs::copy_options::overwrite_existing);
+    }
+
+    ThreadPool pool;
+    std::cout << "Startup from CSV versus snapshot" << std::endl;
+    timeRuns("Load from CSV", [&]() {
+        loadDataset(house, occupation, pool);
+    });
+    DatasetHandle parsed = loadDataset(house, occupation, pool);
+    timeRuns("Write snapshot", [&]() {
+        writeSnapshot(*parsed, snapshot, house, occupation);
+    });
+    std::cout << "  Snapshot size: " << fs::file_size(snapshot) / (1024.0 * 1024.0) << " MiB" << std::endl;
+    timeRuns("Fingerprint both CSVs", [&]() {
+        SourceFingerprint fingerprint;
+        fingerprintFile(house, fingerprint);
+        fingerprintFile(occupation, fingerprint);
+    });
+    timeRuns("Load from snapshot", [&]() {
+        Dataset dataset;
+        readSnapshot(dataset, snapshot, house, occupation);
+    });
+    Dataset restored;
+    bool loaded = readSnapshot(restored, snapshot, house, occupation);
+    std::cout << "  Snapshot loads: " << (loaded ? "yes" : "NO") << ", same rankings as the CSV load: "
+              << (loaded && sameRankings(*parsed, restored) ? "yes" : "NO") << std::endl;
+
+    auto accepted = [&]() {
+        Dataset dataset;
+        return readSnapshot(dataset, snapshot, house, occupation);
+    };
+    // Newer modification time, same contents
+    fs::last_write_time(house, fs::last_write_time(house) + std::chrono::seconds(1));
+    std::cout << "  Rejected after touching the CSV: " << (accepted() ? "NO" : "yes") << std::endl;
+    writeSnapshot(*parsed, snapshot, house, occupation);
+
+    // One byte changed in place with the size and modification time put back
+    auto modified = fs::last_write_time(house);
+    {
+        std::fstream file(house, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(fs::file_size(house) / 2));
+        file.put('#');
+    }
+    fs::last_write_time(house, modified);
+    std::cout << "  Rejected after editing the CSV in place: " << (accepted() ? "NO" : "yes") << std::endl;
+    fs::copy_file(housePath, house, fs::copy_options::overwrite_existing);
+    writeSnapshot(*parsed, snapshot, house, occupation);
+
+    // One byte of the snapshot payload flipped
+    {
+        std::fstream file(snapshot, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(fs::file_size(snapshot) - 1));
+        char last = static_cast<char>(file.get());
+        file.seekp(static_cast<std::streamoff>(fs::file_size(snapshot) - 1));
+        file.put(static_cast<char>(last ^ 1));
+    }
+    std::cout << "  Rejected after corrupting the snapshot: " << (accepted() ? "NO" : "yes") << std::endl;
+    fs::remove_all(directory);
+}
+
+
+// Peak resident set size of the process so far, 0 where /proc is not available
+std::size_t peakResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return static_cast<std::size_t>(std::stoull(line.substr(6))) * 1024;
+        }
+    }
+    return 0;
+}
+
+// Peak resident set of a fresh copy of this program that loads the two files the given way and exits:
+// "stream", "load", or "none" to load nothing. A separate process keeps the heap this
+// benchmark has already grown out of the figure. 0 where that cannot be measured.
+// The paths go to the child as arguments with no shell in between. The child reports its own
+// VmHWM on a pipe: the ru_maxrss wait4 returns is no use here, since Linux carries the peak of the
+// spawning process over the exec into the child's figure.
+std::size_t peakResidentOf(const std::string& mode, const std::string& housePath, const std::string& occupationPath) {
+#ifdef __linux__
+    int pipeFds[2];
+    if (::pipe2(pipeFds, O_CLOEXEC) != 0) {
+        return 0;
+    }
+    std::string program = "/proc/self/exe";
+    std::string flag = "--bench-rss";
+    std::vector<char*> arguments = {&program[0], &flag[0], const_cast<char*>(mode.c_str()),
+                                    const_cast<char*>(housePath.c_str()), const_cast<char*>(occupationPath.c_str()),
+                                    nullptr};
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+    pid_t child = 0;
+    int failed = posix_spawn(&child, program.c_str(), &actions, nullptr, arguments.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(pipeFds[1]);
+    if (failed != 0) {
+        ::close(pipeFds[0]);
+        return 0;
+    }
+
+    std::string output;
+    char buffer[256];
+    ssize_t got;
+    while ((got = ::read(pipeFds[0], buffer, sizeof(buffer))) != 0) {
+        if (got < 0 && errno != EINTR) {
+            break;
+        }
+        if (got > 0) {
+            output.append(buffer, static_cast<std::size_t>(got));
+        }
+    }
+    ::close(pipeFds[0]);
+    int status = 0;
+    while (::waitpid(child, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return 0;
+        }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return 0;
+    }
+    return static_cast<std::size_t>(std::strtoull(output.c_str(), nullptr, 10));
+#else
+    (void) mode;
+    (void) housePath;
+    (void) occupationPath;
+    return 0;
+#endif
+}
+
+// Writes the header of source followed by its rows copies times over
+std::size_t writeRepeated(const std::string& source, const std::string& target, int copies) {
+    std::ifstream in(source, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::size_t headerEnd = contents.find('\n');
+    headerEnd = (headerEnd == std::string::npos) ? contents.size() : headerEnd + 1;
+    std::string rows = contents.substr(headerEnd);
+    if (!rows.empty() && rows.back() != '\n') {
+        rows += '\n';
+    }
+    std::ofstream out(target, std::ios::binary);
+    out << contents.substr(0, headerEnd);
+    for (int copy = 0; copy < copies; copy++) {
+        out << rows;
+    }
+    return headerEnd + rows.size() * static_cast<std::size_t>(copies);
+}
+
+// Streaming aggregation against the full load: time, matching answers, and peak memory as the input grows.
+// Repeating every row leaves each average unchanged, so larger inputs must still rank the same.
+void benchStreaming(const std::string& housePath, const std::string& occupationPath) {
+    namespace fs = std::filesystem;
+    const fs::path directory = fs::temp_directory_path() / "project3-stream-bench";
+    fs::create_directories(directory);
+
+    ThreadPool pool;
+    std::cout << "Streaming aggregation versus a full load" << std::endl;
+    timeRuns("Full load", [&]() {
+        loadDataset(housePath, occupationPath, pool);
+    });
+    timeRuns("Streamed aggregates", [&]() {
+        streamDataset(housePath, occupationPath, pool);
+    });
+    DatasetHandle loaded = loadDataset(housePath, occupationPath, pool);
+    DatasetHandle streamed = streamDataset(housePath, occupationPath, pool);
+    std::cout << "  Same rankings as the full load: "
+              << (loaded && streamed && sameRankings(*loaded, *streamed) ? "yes" : "NO") << std::endl;
+
+    const std::string house = (directory / "PropertyValues.csv").string();
+    const std::string occupation = (directory / "JobSalarys.csv").string();
+    std::size_t baseline = peakResidentOf("none", housePath, occupationPath);
+    if (baseline != 0) {
+        printMegabytes("Peak RSS with nothing loaded", baseline);
+    }
+    for (int copies : {1, 8, 32}) {
+        std::size_t bytes = writeRepeated(housePath, house, copies);
+        if (fileExists(occupationPath)) {
+            bytes += writeRepeated(occupationPath, occupation, copies);
+        }
+        std::cout << "  Input " << copies << "x (" << bytes / (1024.0 * 1024.0) << " MiB)" << std::endl;
+
+        DatasetHandle scaled;
+        double best = timeRuns("  Streamed", [&]() {
+            scaled = streamDataset(house, occupation, pool);
+        });
+        printThroughput("  Streamed", bytes, best);
+        std::cout << "    Same rankings as the 1x full load: "
+                  << (scaled && sameRankings(*loaded, *scaled) ? "yes" : "NO") << std::endl;
+        scaled.reset();
+        if (baseline != 0) {
+            printMegabytes("  Streamed peak RSS", peakResidentOf("stream", house, occupation));
+            // The full load holds every row, so it is only run on the smaller inputs
+            if (copies <= 8) {
+                printMegabytes("  Full load peak RSS", peakResidentOf("load", house, occupation));
+            }
+        }
+    }
+    fs::remove_all(directory);
+}
+
+
+// Top 5 states for every title: a loop over top5States, as the interactive session would run it,
+// against the batch that shares the per-state home values and spreads the titles over the pool.
+// Returns false when the files can not be loaded
+bool benchBatch(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset) {
+        std::cerr << "Error opening files!" << std::endl;
+        return false;
+    }
+    const std::vector<std::string> titles = allTitles(*dataset);
+    const double queries = static_cast<double>(titles.size());
+    auto perSecond = [&](double ms) {
+        return ms > 0 ? queries / (ms / 1000.0) : 0.0;
+    };
+
+    std::cout << "Batch rankings for all " << titles.size() << " titles" << std::endl;
+    double loopMs = timeRuns("Loop over top5States", [&]() {
+        std::ostringstream out;
+        for (const std::string& title : titles) {
+            top5States(title, 5, *dataset, out);
+        }
+    });
+    double rankMs = timeRuns("Loop over rankPlaces", [&]() {
+        for (const std::string& title : titles) {
+            rankPlaces(title, 5, Granularity::State, *dataset);
+        }
+    });
+    double batchMs = timeRuns("Batch", [&]() {
+        rankStatesBatch(titles, 5, *dataset, pool);
+    });
+    double csvMs = timeRuns("Batch written as CSV", [&]() {
+        std::ostringstream out;
+        writeRankingsCsv(rankStatesBatch(titles, 5, *dataset, pool), out);
+    });
+    double jsonMs = timeRuns("Batch written as JSON", [&]() {
+        std::ostringstream out;
+        writeRankingsJson(rankStatesBatch(titles, 5, *dataset, pool), out);
+    });
+    std::cout << "  Queries per second: top5States loop " << perSecond(loopMs) << ", rankPlaces loop "
+              << perSecond(rankMs) << ", batch " << perSecond(batchMs) << ", batch with CSV "
+              << perSecond(csvMs) << ", batch with JSON " << perSecond(jsonMs) << " (" << pool.size()
+              << " threads)" << std::endl;
+
+    bool same = true;
+    std::vector<TitleRanking> rankings = rankStatesBatch(titles, 5, *dataset, pool);
+    for (const TitleRanking& ranking : rankings) {
+        std::vector<PlaceScore> expected = rankPlaces(ranking.title, 5, Granularity::State, *dataset);
+        same = same && expected.size() == ranking.states.size() &&
+               std::equal(expected.begin(), expected.end(), ranking.states.begin(),
+                          [](const PlaceScore& a, const PlaceScore& b) {
+                              return a.state == b.state && a.score == b.score;
+                          });
+    }
+    std::cout << "  Same rankings as rankPlaces: " << (same ? "yes" : "NO") << std::endl;
+    return true;
+}
+
+
+// One question answered by reloading both CSVs, as a run per question does, against the same
+// questions sent to a server that loaded them once. Returns false when the files can not be loaded
+bool benchServer(const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset = loadDataset(housePath, occupationPath, pool);
+    if (!dataset) {
+        std::cerr << "Error opening files!" << std::endl;
+        return false;
+    }
+    std::cout << "Query server against reloading per question" << std::endl;
+    timeRuns("Reload and rank one title", [&]() {
+        DatasetHandle reloaded = loadDataset(housePath, occupationPath, pool);
+        if (reloaded) {
+            rankPlaces("Registered Nurses", 5, Granularity::State, *reloaded);
+        }
+    });
+    timeRuns("Answer 1000 requests in process", [&]() {
+        for (int i = 0; i < 1000; i++) {
+            answerRequest(*dataset, "{\"occupation\": \"Registered Nurses\", \"top\": 5}");
+        }
+    });
+
+    const std::string socketPath = (std::filesystem::temp_directory_path() / "project3-bench.sock").string();
+    QueryServer server(*dataset, pool);
+    std::string error;
+    if (!server.listen(socketPath, error)) {
+        std::cout << "  Server unavailable: " << error << std::endl;
+        return true;
+    }
+    std::thread loop([&server]() {
+        server.run();
+    });
+    for (std::size_t clients : {1, 4, 16}) {
+        LoadReport report;
+        if (!runLoadTest(socketPath, clients, 20000, report, error)) {
+            std::cout << "  Load test failed: " << error << std::endl;
+            break;
+        }
+        std::cout << "  " << clients << " clients: " << report.requests << " requests, " << report.errors
+                  << " errors, p50 " << report.p50Ms << " ms, p99 " << report.p99Ms << " ms, "
+                  << report.queriesPerSecond() << " queries per second" << std::endl;
+    }
+    server.stop();
+    loop.join();
+    std::cout << "  Worker threads: " << pool.size() << std::endl;
+    return true;
+}
+
+}
+
+int runPeakResidentProbe(const std::string& mode, const std::string& housePath, const std::string& occupationPath) {
+    ThreadPool pool;
+    DatasetHandle dataset;
+    if (mode == "stream") {
+        dataset = streamDataset(housePath, occupationPath, pool);
+    } else if (mode == "load") {
+        dataset = loadDataset(housePath, occupationPath, pool);
+    }
+    if (mode != "none" && !dataset) {
+        return 1;
+    }
+    std::cout << peakResidentBytes() << std::endl;
+    return 0;
+}
+
+int runBenchmarks(const std::string& dataDir) {
+    const std::string housePath = dataDir + "/PropertyValues.csv";
+    const std::string occupationPath = dataDir + "/JobSalarys.csv";
+
+    if (!fileExists(housePath)) {
+        std::cerr << "Error opening files!" << std::endl;
+        return 1;
+    }
+
+    benchLoaders(housePath, occupationPath);
+    benchParallelLoad(housePath, occupationPath);
+    benchAllocations(housePath, occupationPath);
+    benchLoadedState(housePath, occupationPath);
+    benchScanner(housePath);
+    benchScanner(occupationPath);
+    benchNumberParse(housePath, {4});
+    benchNumberParse(occupationPath, {3, 4});
+    benchColumnTables(housePath, occupationPath);
+    benchQueryLatency(housePath, occupationPath);
+    benchSortEngine();
+    benchShellGaps(housePath, occupationPath);
+    benchParallelSort(housePath, occupationPath);
+    benchLargeStateSort();
+    benchRadixSort(housePath, occupationPath);
+    benchIndexSort(housePath, occupationPath);
+    benchTopK(housePath, occupationPath);
+    benchSalaryIndex(housePath, occupationPath);
+    benchHomeStats(housePath, occupationPath);
+    benchTitleSearch(housePath, occupationPath);
+    benchFuzzySearch(housePath, occupationPath);
+    benchSnapshot(housePath, occupationPath);
+    benchStreaming(housePath, occupationPath);
+    if (!benchBatch(housePath, occupationPath)) {
+        return 1;
+    }
+    if (!benchServer(housePath, occupationPath)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,14 @@
+#ifndef PROJECT3_BENCH_H
+#define PROJECT3_BENCH_H
+
+#include <string>
+
+// Function that runs the timing comparisons against the CSV files in dataDir
+// Returns the process exit code
+int runBenchmarks(const std::string& dataDir);
+
+// Function that loads the two files one way ("stream", "load" or "none") and prints the peak resident
+// bytes, so the benchmarks can read the memory of a fresh process doing only that. Returns the process exit code
+int runPeakResidentProbe(const std::string& mode, const std::string& housePath, const std::string& occupationPath);
+
+#endif //PROJECT3_BENCH_H
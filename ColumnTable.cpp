@@ -0,0 +1,83 @@
+#include "ColumnTable.h"
+
+#include <algorithm>
+
+namespace {
+
+// Heap bytes behind a vector's buffer
+template <typename T>
+std::size_t vectorBytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+}
+
+std::size_t HouseTable::memoryBytes() const {
+    return vectorBytes(MeanValue) + vectorBytes(State) + vectorBytes(City) + vectorBytes(CountyName) +
+           states.memoryBytes();
+}
+
+std::size_t OccupationTable::memoryBytes() const {
+    return vectorBytes(TOT_EMP) + vectorBytes(A_MEAN) + vectorBytes(AREA) + vectorBytes(PRIM_STATE) +
+           vectorBytes(OCC_TITLE) + states.memoryBytes();
+}
+
+void sortRowsByColumn(const std::vector<double>& column, std::vector<std::uint32_t>& rows) {
+    std::sort(rows.begin(), rows.end(), [&column](std::uint32_t a, std::uint32_t b) {
+        if (valueLess(column[a], column[b])) {
+            return true;
+        }
+        if (valueLess(column[b], column[a])) {
+            return false;
+        }
+        return a < b;
+    });
+}
+
+HouseTable buildHouseTable(const HouseMap& houseData) {
+    HouseTable table;
+    std::size_t total = 0;
+    for (const auto& entry : houseData) {
+        total += entry.second.size();
+    }
+    table.MeanValue.reserve(total);
+    table.State.reserve(total);
+    table.City.reserve(total);
+    table.CountyName.reserve(total);
+
+    for (const auto& entry : houseData) {
+        std::uint32_t state = table.states.intern(entry.first);
+        for (const HouseInfo& house : entry.second) {
+            table.MeanValue.push_back(house.MeanValue);
+            table.State.push_back(state);
+            table.City.push_back(house.City);
+            table.CountyName.push_back(house.CountyName);
+        }
+    }
+    return table;
+}
+
+OccupationTable buildOccupationTable(const OccupationMap& occupationData) {
+    OccupationTable table;
+    std::size_t total = 0;
+    for (const auto& entry : occupationData) {
+        total += entry.second.size();
+    }
+    table.TOT_EMP.reserve(total);
+    table.A_MEAN.reserve(total);
+    table.AREA.reserve(total);
+    table.PRIM_STATE.reserve(total);
+    table.OCC_TITLE.reserve(total);
+
+    for (const auto& entry : occupationData) {
+        std::uint32_t state = table.states.intern(entry.first);
+        for (const Occupation& occupation : entry.second) {
+            table.TOT_EMP.push_back(occupation.TOT_EMP);
+            table.A_MEAN.push_back(occupation.A_MEAN);
+            table.AREA.push_back(occupation.AREA);
+            table.PRIM_STATE.push_back(state);
+            table.OCC_TITLE.push_back(occupation.OCC_TITLE);
+        }
+    }
+    return table;
+}
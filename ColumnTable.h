@@ -0,0 +1,49 @@
+#ifndef PROJECT3_COLUMNTABLE_H
+#define PROJECT3_COLUMNTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Records.h"
+#include "StringPool.h"
+
+// Columnar copy of the housing data: one contiguous array per field
+// City and CountyName hold stringPool() ids; State holds dense ids into states
+class HouseTable {
+public:
+    std::vector<double> MeanValue;
+    std::vector<std::uint32_t> State;
+    std::vector<StringId> City;
+    std::vector<StringId> CountyName;
+
+    StringDictionary states;
+
+    std::size_t rows() const { return MeanValue.size(); }
+    std::size_t memoryBytes() const;
+};
+
+// Columnar copy of the salary data: one contiguous array per field
+// AREA and OCC_TITLE hold stringPool() ids; PRIM_STATE holds dense ids into states
+class OccupationTable {
+public:
+    std::vector<double> TOT_EMP;
+    std::vector<double> A_MEAN;
+    std::vector<StringId> AREA;
+    std::vector<std::uint32_t> PRIM_STATE;
+    std::vector<StringId> OCC_TITLE;
+
+    StringDictionary states;
+
+    std::size_t rows() const { return A_MEAN.size(); }
+    std::size_t memoryBytes() const;
+};
+
+// Function to sort row numbers by a numeric column, missing values last and ties in row order
+void sortRowsByColumn(const std::vector<double>& column, std::vector<std::uint32_t>& rows);
+
+// Functions to build the columnar tables from the per-state record maps
+HouseTable buildHouseTable(const HouseMap& houseData);
+OccupationTable buildOccupationTable(const OccupationMap& occupationData);
+
+#endif //PROJECT3_COLUMNTABLE_H
@@ -0,0 +1,202 @@
+#include "CommandLine.h"
+
+#include <cctype>
+
+namespace {
+
+bool parseFormat(const std::string& text, ReportFormat& format) {
+    if (text == "text") {
+        format = ReportFormat::Text;
+    } else if (text == "csv") {
+        format = ReportFormat::Csv;
+    } else if (text == "json") {
+        format = ReportFormat::Json;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool parseCount(const std::string& text, std::size_t& count) {
+    // Nine digits at most, so the value can never overflow
+    if (text.empty() || text.size() > 9) {
+        return false;
+    }
+    std::size_t value = 0;
+    for (char c : text) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+        value = value * 10 + static_cast<std::size_t>(c - '0');
+    }
+    if (value == 0) {
+        return false;
+    }
+    count = value;
+    return true;
+}
+
+bool parseCommandLine(int argc, char* argv[], CommandLine& options, std::string& error) {
+    // Flags that pick what the run does; at most one may be given
+    int modes = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        std::string value;
+        bool hasValue = false;
+        std::size_t equals = flag.find('=');
+        if (flag.compare(0, 2, "--") == 0 && equals != std::string::npos) {
+            value = flag.substr(equals + 1);
+            flag.erase(equals);
+            hasValue = true;
+        }
+        // Fetches the flag's value from after '=' or from the next argument
+        auto takeValue = [&]() {
+            if (!hasValue) {
+                if (i + 1 >= argc) {
+                    error = flag + " needs a value";
+                    return false;
+                }
+                value = argv[++i];
+                hasValue = true;
+            }
+            return true;
+        };
+        auto noValue = [&]() {
+            if (hasValue) {
+                error = flag + " does not take a value";
+                return false;
+            }
+            return true;
+        };
+
+        if (flag == "--occupation") {
+            if (!takeValue()) {
+                return false;
+            }
+            options.occupation = value;
+            options.mode = RunMode::Query;
+            modes++;
+        } else if (flag == "--batch") {
+            if (!takeValue()) {
+                return false;
+            }
+            options.batch = value;
+            options.mode = RunMode::Batch;
+            modes++;
+        } else if (flag == "--serve" || flag == "--load-test") {
+            if (!takeValue()) {
+                return false;
+            }
+            options.socketPath = value;
+            options.mode = (flag == "--serve") ? RunMode::Serve : RunMode::LoadTest;
+            modes++;
+        } else if (flag == "--clients" || flag == "--requests") {
+            if (!takeValue()) {
+                return false;
+            }
+            std::size_t& count = (flag == "--clients") ? options.clients : options.requests;
+            if (!parseCount(value, count)) {
+                error = flag + " needs a positive whole number, not '" + value + "'";
+                return false;
+            }
+        } else if (flag == "--top") {
+            if (!takeValue()) {
+                return false;
+            }
+            if (!parseCount(value, options.top)) {
+                error = "--top needs a positive whole number, not '" + value + "'";
+                return false;
+            }
+        } else if (flag == "--data-dir") {
+            if (!takeValue()) {
+                return false;
+            }
+            options.dataDir = value;
+        } else if (flag == "--snapshot") {
+            if (!takeValue()) {
+                return false;
+            }
+            if (value.empty()) {
+                error = "--snapshot needs a file path";
+                return false;
+            }
+            options.snapshotPath = value;
+        } else if (flag == "--format") {
+            if (!takeValue()) {
+                return false;
+            }
+            if (!parseFormat(value, options.format)) {
+                error = "--format is one of text, csv or json, not '" + value + "'";
+                return false;
+            }
+        } else if (flag == "--bench") {
+            if (!noValue()) {
+                return false;
+            }
+            options.mode = RunMode::Bench;
+            modes++;
+        } else if (flag == "--stream") {
+            if (!noValue()) {
+                return false;
+            }
+            options.stream = true;
+        } else if (flag == "--no-snapshot") {
+            if (!noValue()) {
+                return false;
+            }
+            options.noSnapshot = true;
+        } else if (flag == "--timing") {
+            if (!noValue()) {
+                return false;
+            }
+            options.timing = true;
+        } else if (flag == "--interactive") {
+            if (!noValue()) {
+                return false;
+            }
+            options.mode = RunMode::Interactive;
+            modes++;
+        } else if (flag == "--help" || flag == "-h") {
+            options.mode = RunMode::Help;
+            return true;
+        } else {
+            error = "Unknown option '" + std::string(argv[i]) + "'";
+            return false;
+        }
+    }
+
+    if (modes > 1) {
+        error = "Only one of --occupation, --batch, --serve, --load-test, --bench and --interactive can be given";
+        return false;
+    }
+    if (options.noSnapshot && !options.snapshotPath.empty()) {
+        error = "--snapshot and --no-snapshot cannot both be given";
+        return false;
+    }
+    return true;
+}
+
+void printUsage(std::ostream& out) {
+    out << "Usage: Project3 [options]\n"
+           "\n"
+           "With no query options the interactive menu starts, as with --interactive.\n"
+           "\n"
+           "  --occupation TITLE  Rank the best states for TITLE, or for the one title a keyword finds\n"
+           "  --batch all|FILE    Rank the best states for every title, or for each line of FILE\n"
+           "  --serve SOCKET      Load once and answer JSON queries on a Unix domain socket until interrupted\n"
+           "  --load-test SOCKET  Send queries to a server and report p50/p99 latency and queries per second\n"
+           "  --clients N         Connections the load test opens at once (default 8)\n"
+           "  --requests N        Queries the load test sends in total (default 20000)\n"
+           "  --top N             Number of states to rank (default 5)\n"
+           "  --format FORMAT     Output as text, csv or json (default text)\n"
+           "  --data-dir DIR      Directory holding PropertyValues.csv and JobSalarys.csv (default ..)\n"
+           "  --snapshot FILE     Keep the snapshot that speeds up later starts in FILE (default DIR/Project3.snapshot)\n"
+           "  --no-snapshot       Always load from the CSV files and write no snapshot\n"
+           "  --stream            Aggregate the files in one streaming pass instead of loading every row\n"
+           "  --timing            Report load and query times in milliseconds on stderr\n"
+           "  --bench             Run the timing comparisons against the files in the data directory\n"
+           "  --interactive       Start the interactive menu\n"
+           "  --help              Show this message\n";
+}
@@ -0,0 +1,47 @@
+#ifndef PROJECT3_COMMANDLINE_H
+#define PROJECT3_COMMANDLINE_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "Batch.h"
+
+// What a run of the program does
+enum class RunMode { Interactive, Query, Batch, Serve, LoadTest, Bench, Help };
+
+// Options parsed from the command line; anything not given keeps its default here
+struct CommandLine {
+    RunMode mode = RunMode::Interactive;
+    std::string dataDir = "..";
+    // Where the load snapshot is read from and written to; empty for Project3.snapshot in dataDir
+    std::string snapshotPath;
+    bool noSnapshot = false;
+    // Title or search keyword of a single query
+    std::string occupation;
+    // "all" or a file listing one title per line
+    std::string batch;
+    // Unix domain socket the server listens on, or the load test connects to
+    std::string socketPath;
+    std::size_t clients = 8;
+    std::size_t requests = 20000;
+    std::size_t top = 5;
+    ReportFormat format = ReportFormat::Text;
+    bool stream = false;
+    bool timing = false;
+};
+
+// Function to parse a positive whole number of at most nine digits into count. Returns false,
+// leaving count alone, for anything else, including zero.
+bool parseCount(const std::string& text, std::size_t& count);
+
+// Function to parse argv into options. Flags take their value as the next argument or after '='
+// (--top 3 or --top=3). The interactive menu runs when no query, batch, server, load test or bench
+// is asked for. Returns false with a message in error for an unknown flag, a missing or bad value,
+// or a combination that does not make sense.
+bool parseCommandLine(int argc, char* argv[], CommandLine& options, std::string& error);
+
+// Function to print the flags and what they do
+void printUsage(std::ostream& out);
+
+#endif //PROJECT3_COMMANDLINE_H
@@ -0,0 +1,356 @@
+#include "CsvLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory_resource>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+#include "NumberParse.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) {
+        void* address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        ::madvise(address, length, MADV_SEQUENTIAL);
+        buffer = static_cast<char*>(address);
+        mapped = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    fallbackBuffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    buffer = &fallbackBuffer[0];
+    length = fallbackBuffer.size();
+#endif
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapped) {
+        ::munmap(buffer, length);
+    }
+#endif
+    fallbackBuffer.clear();
+    buffer = nullptr;
+    length = 0;
+    mapped = false;
+    opened = false;
+}
+
+CsvReader::CsvReader(char* begin, char* end)
+        : cursor(begin), last(end), blockStart(begin), scanned(begin), level(detectScanLevel()) {
+    offsets.reserve(blockSize / 4);
+}
+
+// Returns the next delimiter or newline outside quotes, scanning further blocks as needed
+char* CsvReader::nextStructural() {
+    while (nextOffset == offsets.size()) {
+        if (scanned >= last) {
+            return last;
+        }
+        offsets.clear();
+        nextOffset = 0;
+        blockStart = scanned;
+        std::size_t length = std::min(blockSize, static_cast<std::size_t>(last - scanned));
+        scanStructural(level, blockStart, length, inQuotes, offsets);
+        scanned += length;
+    }
+    return blockStart + offsets[nextOffset++];
+}
+
+// Strips the quotes from a field spanning [start, stop), collapsing "" to " in place
+std::string_view CsvReader::unquote(char* start, char* stop) {
+    char* read = start + 1;
+    char* write = read;
+    while (read < stop) {
+        if (*read == '"') {
+            if (read + 1 < stop && read[1] == '"') {
+                *write++ = '"';
+                read += 2;
+                continue;
+            }
+            // Anything between the closing quote and the delimiter is dropped
+            break;
+        }
+        // Only touch the buffer once an escape has shifted the field, so untouched pages stay shared
+        if (write != read) {
+            *write = *read;
+        }
+        ++write;
+        ++read;
+    }
+    return std::string_view(start + 1, static_cast<std::size_t>(write - (start + 1)));
+}
+
+bool CsvReader::nextRow(std::vector<std::string_view>& fields) {
+    fields.clear();
+    if (cursor >= last) {
+        return false;
+    }
+    while (true) {
+        char* stop = nextStructural();
+        char* end = stop;
+        if (end > cursor && end[-1] == '\r' && (stop == last || *stop == '\n')) {
+            --end;
+        }
+        if (cursor < end && *cursor == '"') {
+            fields.push_back(unquote(cursor, end));
+        } else {
+            fields.emplace_back(cursor, static_cast<std::size_t>(end - cursor));
+        }
+
+        if (stop >= last) {
+            cursor = last;
+            return true;
+        }
+        cursor = stop + 1;
+        if (*stop == '\n') {
+            return true;
+        }
+        // A trailing comma at the end of the buffer still produces an empty field
+        if (cursor >= last) {
+            fields.emplace_back();
+            return true;
+        }
+    }
+}
+
+bool quoteOpenAt(const char* begin, const char* end, bool inQuotes) {
+    return inQuotes != (std::count(begin, end, '"') % 2 == 1);
+}
+
+namespace {
+
+// Smallest chunk worth handing to another thread
+const std::size_t minChunkBytes = 64 * 1024;
+
+// A parsed slice of one file before it is merged. Its containers live in the chunk's own
+// arena, which is thrown away whole once the records have been copied out.
+template <typename T>
+struct ParsedChunk {
+    std::pmr::monotonic_buffer_resource arena;
+    StateMap<T> records{&arena};
+    std::pmr::unordered_set<StringId> titles{&arena};
+};
+
+// Moves past the header row and returns the start of the first record
+char* skipHeader(char* begin, char* end) {
+    char* newline = static_cast<char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+    return newline ? newline + 1 : end;
+}
+
+// Splits [begin, end) into up to count ranges that each end just after a newline.
+// A newline inside a quoted field is part of the field, so cuts are only made at newlines
+// outside quotes; the quote state is carried along from begin, which must start a row.
+std::vector<std::pair<char*, char*>> splitChunks(char* begin, char* end, std::size_t count) {
+    std::vector<std::pair<char*, char*>> chunks;
+    std::size_t size = static_cast<std::size_t>(end - begin);
+    count = std::max<std::size_t>(1, std::min(count, size / minChunkBytes));
+    std::size_t step = size / count;
+    char* start = begin;
+    // Everything before scanned has been counted into inQuotes
+    char* scanned = begin;
+    bool inQuotes = false;
+    for (std::size_t i = 1; i < count && start < end; i++) {
+        char* cut = std::max(scanned, begin + i * step);
+        inQuotes = quoteOpenAt(scanned, cut, inQuotes);
+        scanned = cut;
+        char* newline = nullptr;
+        while (scanned < end) {
+            char* next = static_cast<char*>(std::memchr(scanned, '\n', static_cast<std::size_t>(end - scanned)));
+            if (!next) {
+                scanned = end;
+                break;
+            }
+            inQuotes = quoteOpenAt(scanned, next, inQuotes);
+            scanned = next + 1;
+            if (!inQuotes) {
+                newline = next;
+                break;
+            }
+        }
+        if (!newline) {
+            break;
+        }
+        chunks.emplace_back(start, newline + 1);
+        start = newline + 1;
+    }
+    if (start < end) {
+        chunks.emplace_back(start, end);
+    }
+    return chunks;
+}
+
+void parseHouseChunk(char* begin, char* end, HouseMap& houseData) {
+    CsvReader reader(begin, end);
+    StringPoolCache strings(stringPool());
+    std::vector<std::string_view> fields;
+    fields.reserve(8);
+    while (reader.nextRow(fields)) {
+        if (fields.size() < 5) {
+            continue;
+        }
+        double MeanValue = parseNumber(fields[4]).value_or(missingValue);
+        houseData[std::string(fields[1])].emplace_back(strings.intern(fields[0]), strings.intern(fields[1]),
+                                                       strings.intern(fields[2]), strings.intern(fields[3]), MeanValue);
+    }
+}
+
+void parseOccupationChunk(char* begin, char* end, ParsedChunk<Occupation>& chunk) {
+    CsvReader reader(begin, end);
+    StringPoolCache strings(stringPool());
+    std::vector<std::string_view> fields;
+    fields.reserve(8);
+    while (reader.nextRow(fields)) {
+        if (fields.size() < 5) {
+            continue;
+        }
+        double TOT_EMP = parseNumber(fields[3]).value_or(missingValue);
+        double A_MEAN = parseNumber(fields[4]).value_or(missingValue);
+
+        StringId title = strings.intern(fields[2]);
+        chunk.records[std::string(fields[1])].emplace_back(strings.intern(fields[0]), strings.intern(fields[1]),
+                                                                  title, TOT_EMP, A_MEAN);
+        chunk.titles.insert(title);
+    }
+}
+
+// Appends each chunk's per-state vectors in file order, so the result matches a sequential load.
+// Totals are counted first so every target vector is allocated exactly once.
+template <typename T>
+void mergeStates(StateMap<T>& target, std::deque<ParsedChunk<T>>& parts) {
+    std::map<std::string, std::size_t> totals;
+    for (const ParsedChunk<T>& part : parts) {
+        for (const auto& entry : part.records) {
+            totals[entry.first] += entry.second.size();
+        }
+    }
+    for (const auto& total : totals) {
+        std::pmr::vector<T>& destination = target[total.first];
+        destination.reserve(destination.size() + total.second);
+    }
+    for (ParsedChunk<T>& part : parts) {
+        for (const auto& entry : part.records) {
+            std::pmr::vector<T>& destination = target[entry.first];
+            destination.insert(destination.end(), entry.second.begin(), entry.second.end());
+        }
+        part.records.clear();
+    }
+}
+
+void mergeTitles(std::set<std::string_view>& occupationNames, const std::pmr::unordered_set<StringId>& titles) {
+    for (StringId title : titles) {
+        occupationNames.insert(stringPool().str(title));
+    }
+}
+
+}
+
+bool loadHouseData(const std::string& path, HouseMap& houseData) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    std::deque<ParsedChunk<HouseInfo>> parts(1);
+    parseHouseChunk(skipHeader(file.begin(), file.end()), file.end(), parts[0].records);
+    mergeStates(houseData, parts);
+    return true;
+}
+
+bool loadOccupationData(const std::string& path, OccupationMap& occupationData,
+                        std::set<std::string_view>& occupationNames) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    std::deque<ParsedChunk<Occupation>> parts(1);
+    parseOccupationChunk(skipHeader(file.begin(), file.end()), file.end(), parts[0]);
+    mergeTitles(occupationNames, parts[0].titles);
+    mergeStates(occupationData, parts);
+    return true;
+}
+
+bool loadDataFiles(const std::string& housePath, const std::string& occupationPath, HouseMap& houseData,
+                   OccupationMap& occupationData, std::set<std::string_view>& occupationNames,
+                   ThreadPool& pool) {
+    MappedFile houseFile, occupationFile;
+    if (!houseFile.open(housePath)) {
+        return false;
+    }
+    // As before, a missing salary file just leaves the occupation data empty
+    occupationFile.open(occupationPath);
+
+    // Both files are cut into chunks up front so their parsing overlaps on the pool
+    const std::size_t chunksPerFile = pool.size() * 2;
+    auto houseChunks = splitChunks(skipHeader(houseFile.begin(), houseFile.end()), houseFile.end(), chunksPerFile);
+    std::vector<std::pair<char*, char*>> occupationChunks;
+    if (occupationFile.size() > 0) {
+        occupationChunks = splitChunks(skipHeader(occupationFile.begin(), occupationFile.end()),
+                                       occupationFile.end(), chunksPerFile);
+    }
+
+    std::deque<ParsedChunk<HouseInfo>> houseParts(houseChunks.size());
+    std::deque<ParsedChunk<Occupation>> occupationParts(occupationChunks.size());
+    std::vector<std::future<void>> pending;
+    pending.reserve(houseChunks.size() + occupationChunks.size());
+    for (std::size_t i = 0; i < houseChunks.size(); i++) {
+        pending.push_back(pool.submit([&, i]() {
+            parseHouseChunk(houseChunks[i].first, houseChunks[i].second, houseParts[i].records);
+        }));
+    }
+    for (std::size_t i = 0; i < occupationChunks.size(); i++) {
+        pending.push_back(pool.submit([&, i]() {
+            parseOccupationChunk(occupationChunks[i].first, occupationChunks[i].second, occupationParts[i]);
+        }));
+    }
+    for (std::future<void>& task : pending) {
+        task.get();
+    }
+
+    // The two merges touch separate maps, so they can run side by side as well
+    std::future<void> houseMerge = pool.submit([&]() {
+        mergeStates(houseData, houseParts);
+    });
+    for (const ParsedChunk<Occupation>& part : occupationParts) {
+        mergeTitles(occupationNames, part.titles);
+    }
+    mergeStates(occupationData, occupationParts);
+    houseMerge.get();
+    return true;
+}
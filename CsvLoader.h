@@ -0,0 +1,89 @@
+#ifndef PROJECT3_CSVLOADER_H
+#define PROJECT3_CSVLOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CsvScanner.h"
+#include "Records.h"
+#include "ThreadPool.h"
+
+// Class holding the full contents of a file, memory-mapped where the platform allows it.
+// The mapping is private and writable so the CSV reader can unescape quoted fields in place
+// without the changes ever reaching the file on disk.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return opened; }
+    char* begin() { return buffer; }
+    char* end() { return buffer + length; }
+    std::size_t size() const { return length; }
+
+private:
+    char* buffer = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+    bool opened = false;
+    std::string fallbackBuffer;
+};
+
+// Class that splits a CSV buffer into rows of string_view fields without copying them.
+// Field boundaries come from the vectorized structural scan, run one block at a time so
+// the offsets stay in cache. Quoted fields are returned without their quotes and a doubled
+// quote inside one is collapsed in place, so the views stay valid as long as the buffer.
+class CsvReader {
+public:
+    CsvReader(char* begin, char* end);
+
+    // Fills fields with the next row, returns false once the buffer is exhausted
+    bool nextRow(std::vector<std::string_view>& fields);
+
+private:
+    char* nextStructural();
+    std::string_view unquote(char* start, char* stop);
+
+    static constexpr std::size_t blockSize = 64 * 1024;
+
+    char* cursor;
+    char* last;
+    char* blockStart;
+    char* scanned;
+    bool inQuotes = false;
+    ScanLevel level;
+    std::vector<std::uint32_t> offsets;
+    std::size_t nextOffset = 0;
+};
+
+// Function that returns whether a quoted field is open at end, given whether one was open at begin.
+// Every quote flips the state, both halves of an escaped "" included, so only their count matters.
+bool quoteOpenAt(const char* begin, const char* end, bool inQuotes);
+
+// Function to load PropertyValues.csv into per-state vectors, returns false if the file cannot be opened
+// Numeric fields that are blank or suppressed are stored as missingValue
+bool loadHouseData(const std::string& path, HouseMap& houseData);
+
+// Function to load JobSalarys.csv into per-state vectors and collect the distinct occupation titles
+// Text fields are interned into stringPool(), and the titles view strings owned by the pool
+bool loadOccupationData(const std::string& path, OccupationMap& occupationData,
+                        std::set<std::string_view>& occupationNames);
+
+// Function to load both files concurrently: each is split into newline-aligned chunks that are
+// parsed on the pool into per-chunk maps, then merged in file order. Returns false if the
+// housing file cannot be opened; a missing salary file leaves the occupation data empty.
+bool loadDataFiles(const std::string& housePath, const std::string& occupationPath, HouseMap& houseData,
+                   OccupationMap& occupationData, std::set<std::string_view>& occupationNames,
+                   ThreadPool& pool);
+
+#endif //PROJECT3_CSVLOADER_H
@@ -0,0 +1,141 @@
+#include "CsvScanner.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PROJECT3_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void scanScalar(const char* data, std::size_t begin, std::size_t size, bool& inQuotes,
+                       std::vector<std::uint32_t>& offsets) {
+    for (std::size_t i = begin; i < size; i++) {
+        char c = data[i];
+        if (c == '"') {
+            inQuotes = !inQuotes;
+        } else if (!inQuotes && (c == ',' || c == '\n')) {
+            offsets.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+#ifdef PROJECT3_X86_SIMD
+
+// Bits set for every position inside a quoted run, given a mask of quote characters.
+// Each quote flips the state, so this is a prefix xor across the 64 bits.
+inline std::uint64_t prefixXor(std::uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Turns the quote/delimiter masks of one 64 byte block into structural offsets
+inline void emitBlock(std::uint64_t quotes, std::uint64_t delimiters, std::uint32_t base, bool& inQuotes,
+                      std::vector<std::uint32_t>& offsets) {
+    std::uint64_t quoted = prefixXor(quotes) ^ (inQuotes ? ~0ULL : 0ULL);
+    inQuotes = (quoted >> 63) != 0;
+    std::uint64_t structural = delimiters & ~quoted;
+    while (structural != 0) {
+        offsets.push_back(base + static_cast<std::uint32_t>(__builtin_ctzll(structural)));
+        structural &= structural - 1;
+    }
+}
+
+__attribute__((target("sse2")))
+std::size_t scanSse2(const char* data, std::size_t size, bool& inQuotes, std::vector<std::uint32_t>& offsets) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    std::size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        std::uint64_t quotes = 0, delimiters = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + lane * 16));
+            std::uint64_t q = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)));
+            std::uint64_t d = static_cast<std::uint32_t>(_mm_movemask_epi8(
+                    _mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, newline))));
+            quotes |= q << (lane * 16);
+            delimiters |= d << (lane * 16);
+        }
+        emitBlock(quotes, delimiters, static_cast<std::uint32_t>(i), inQuotes, offsets);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+std::size_t scanAvx2(const char* data, std::size_t size, bool& inQuotes, std::vector<std::uint32_t>& offsets) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    std::size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        std::uint64_t quotes =
+                static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, quote))) |
+                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+                        _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, quote)))) << 32);
+        std::uint64_t delimiters =
+                static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(low, comma), _mm256_cmpeq_epi8(low, newline)))) |
+                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(high, comma), _mm256_cmpeq_epi8(high, newline))))) << 32);
+        emitBlock(quotes, delimiters, static_cast<std::uint32_t>(i), inQuotes, offsets);
+    }
+    return i;
+}
+
+#endif
+
+}
+
+ScanLevel detectScanLevel() {
+#ifdef PROJECT3_X86_SIMD
+    static const ScanLevel level = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return ScanLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return ScanLevel::SSE2;
+        }
+        return ScanLevel::Scalar;
+    }();
+    return level;
+#else
+    return ScanLevel::Scalar;
+#endif
+}
+
+const char* scanLevelName(ScanLevel level) {
+    switch (level) {
+        case ScanLevel::AVX2:
+            return "AVX2";
+        case ScanLevel::SSE2:
+            return "SSE2";
+        default:
+            return "Scalar";
+    }
+}
+
+void scanStructural(ScanLevel level, const char* data, std::size_t size, bool& inQuotes,
+                    std::vector<std::uint32_t>& offsets) {
+    std::size_t done = 0;
+#ifdef PROJECT3_X86_SIMD
+    if (level == ScanLevel::AVX2) {
+        done = scanAvx2(data, size, inQuotes, offsets);
+    } else if (level == ScanLevel::SSE2) {
+        done = scanSse2(data, size, inQuotes, offsets);
+    }
+#else
+    (void) level;
+#endif
+    // Whatever is left over (the tail, or everything on the scalar path)
+    scanScalar(data, done, size, inQuotes, offsets);
+}
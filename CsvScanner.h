@@ -0,0 +1,27 @@
+#ifndef PROJECT3_CSVSCANNER_H
+#define PROJECT3_CSVSCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Instruction sets the structural scanner can use, in increasing order of width
+enum class ScanLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Function that returns the widest scan level the running CPU supports (checked once)
+ScanLevel detectScanLevel();
+
+// Function that returns a printable name for a scan level
+const char* scanLevelName(ScanLevel level);
+
+// Function that appends the offset of every ',' and '\n' in [data, data + size) that is not
+// inside a quoted field. inQuotes carries the quote state from one block into the next.
+// Offsets are relative to data, so blocks must be smaller than 4 GiB.
+void scanStructural(ScanLevel level, const char* data, std::size_t size, bool& inQuotes,
+                    std::vector<std::uint32_t>& offsets);
+
+#endif //PROJECT3_CSVSCANNER_H
@@ -0,0 +1,65 @@
+#include "Dataset.h"
+
+#include "CsvLoader.h"
+#include "Snapshot.h"
+
+void* CountingResource::do_allocate(std::size_t size, std::size_t alignment) {
+    blockCount.fetch_add(1, std::memory_order_relaxed);
+    byteCount.fetch_add(size, std::memory_order_relaxed);
+    return std::pmr::new_delete_resource()->allocate(size, alignment);
+}
+
+void CountingResource::do_deallocate(void* pointer, std::size_t size, std::size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+// The salary arena starts larger since that file has roughly four times the rows
+Dataset::Dataset()
+        : houseArena(1024 * 1024, &upstream),
+          occupationArena(4 * 1024 * 1024, &upstream),
+          houseData(&houseArena),
+          occupationData(&occupationArena) {}
+
+bool Dataset::load(const std::string& housePath, const std::string& occupationPath, ThreadPool& pool) {
+    if (!loadDataFiles(housePath, occupationPath, houseData, occupationData, occupationNames, pool)) {
+        return false;
+    }
+    houseTable = buildHouseTable(houseData);
+    occupationTable = buildOccupationTable(occupationData);
+    salaryIndex = buildSalaryIndex(occupationTable);
+    homeStats = buildHomeValueStats(houseTable);
+    titleIndex = buildTitleIndex(occupationNames);
+    return true;
+}
+
+std::size_t Dataset::memoryBytes() const {
+    std::size_t homeStatsBytes = homeStats.byState.capacity() * sizeof(ValueStats) +
+                                 (homeStats.byCounty.capacity() + homeStats.byCity.capacity()) * sizeof(PlaceStats);
+    // A set node holds the view, its colour and three links
+    std::size_t namesBytes = occupationNames.size() * (sizeof(std::string_view) + 4 * sizeof(void*));
+    return arenaBytes() + namesBytes + houseTable.memoryBytes() + occupationTable.memoryBytes() +
+           salaryIndex.memoryBytes() + homeStatsBytes + titleIndex.memoryBytes();
+}
+
+std::shared_ptr<const Dataset> loadDataset(const std::string& housePath, const std::string& occupationPath,
+                                           ThreadPool& pool, const std::string& snapshotPath) {
+    if (!snapshotPath.empty()) {
+        auto dataset = std::make_shared<Dataset>();
+        if (readSnapshot(*dataset, snapshotPath, housePath, occupationPath)) {
+            return dataset;
+        }
+    }
+    auto dataset = std::make_shared<Dataset>();
+    if (!dataset->load(housePath, occupationPath, pool)) {
+        return nullptr;
+    }
+    if (!snapshotPath.empty()) {
+        // A snapshot that cannot be written only costs the next start its speed-up
+        writeSnapshot(*dataset, snapshotPath, housePath, occupationPath);
+    }
+    return dataset;
+}
@@ -0,0 +1,81 @@
+#ifndef PROJECT3_DATASET_H
+#define PROJECT3_DATASET_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "Aggregates.h"
+#include "ColumnTable.h"
+#include "Records.h"
+#include "ThreadPool.h"
+#include "TitleIndex.h"
+
+// Class forwarding to the default heap while counting the blocks and bytes handed out
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t blocks() const { return blockCount; }
+    std::size_t bytes() const { return byteCount; }
+
+private:
+    void* do_allocate(std::size_t size, std::size_t alignment) override;
+    void do_deallocate(void* pointer, std::size_t size, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::atomic<std::size_t> blockCount{0};
+    std::atomic<std::size_t> byteCount{0};
+};
+
+// Class owning everything built by one load of the two data files. Map nodes and record
+// vectors are carved out of the dataset's arenas in a few large blocks, and are all released
+// together when the dataset is destroyed.
+class Dataset {
+    // Declared first so they outlive the containers that allocate from them
+    CountingResource upstream;
+    std::pmr::monotonic_buffer_resource houseArena;
+    std::pmr::monotonic_buffer_resource occupationArena;
+
+public:
+    Dataset();
+
+    Dataset(const Dataset&) = delete;
+    Dataset& operator=(const Dataset&) = delete;
+
+    // Loads both files and builds the columnar tables and aggregates, returns false if the housing file cannot be opened
+    bool load(const std::string& housePath, const std::string& occupationPath, ThreadPool& pool);
+
+    // Blocks and bytes the arenas have taken from the heap
+    std::size_t arenaBlocks() const { return upstream.blocks(); }
+    std::size_t arenaBytes() const { return upstream.bytes(); }
+
+    // Approximate heap bytes held by the dataset: the arenas behind the record maps, the columnar
+    // tables, the aggregates and the title index. The text lives once in stringPool() and is not counted.
+    std::size_t memoryBytes() const;
+
+    HouseMap houseData;
+    OccupationMap occupationData;
+    std::set<std::string_view> occupationNames;
+
+    // Columnar copies used by the queries
+    HouseTable houseTable;
+    OccupationTable occupationTable;
+
+    // Aggregates precomputed from the tables so queries do not rescan them
+    SalaryIndex salaryIndex;
+    HomeValueStats homeStats;
+
+    // Word and prefix search over occupationNames
+    TitleIndex titleIndex;
+};
+
+// Function to load a dataset and hand it out as read-only, returns nullptr if the housing file cannot be opened.
+// Given a snapshotPath, a snapshot that still matches both CSVs is used instead of parsing them,
+// and after a load from the CSVs a fresh snapshot is written there for the next start.
+std::shared_ptr<const Dataset> loadDataset(const std::string& housePath, const std::string& occupationPath,
+                                           ThreadPool& pool, const std::string& snapshotPath = std::string());
+
+#endif //PROJECT3_DATASET_H
@@ -0,0 +1,62 @@
+#include "NumberParse.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// from_chars also reads "inf" and "nan" (after a '-' that gets past the first-character check),
+// which are not values the data can hold
+std::optional<double> fromChars(const char* first, const char* last) {
+    double value = 0.0;
+    auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last || !std::isfinite(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+}
+
+std::optional<double> parseNumber(std::string_view field) {
+    while (!field.empty() && field.front() == ' ') {
+        field.remove_prefix(1);
+    }
+    while (!field.empty() && field.back() == ' ') {
+        field.remove_suffix(1);
+    }
+    // from_chars rejects a leading '+', and anything not starting like a number is a marker
+    if (!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+    }
+    if (field.empty() || !(isDigit(field.front()) || field.front() == '-' || field.front() == '.')) {
+        return std::nullopt;
+    }
+
+    if (field.find(',') == std::string_view::npos) {
+        return fromChars(field.data(), field.data() + field.size());
+    }
+
+    // Drop thousands separators into a stack buffer; a comma that is not between digits is malformed
+    char digits[64];
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < field.size(); i++) {
+        char c = field[i];
+        if (c == ',') {
+            if (i == 0 || i + 1 == field.size() || !isDigit(field[i - 1]) || !isDigit(field[i + 1])) {
+                return std::nullopt;
+            }
+            continue;
+        }
+        if (count == sizeof(digits)) {
+            return std::nullopt;
+        }
+        digits[count++] = c;
+    }
+    return fromChars(digits, digits + count);
+}
@@ -0,0 +1,13 @@
+#ifndef PROJECT3_NUMBERPARSE_H
+#define PROJECT3_NUMBERPARSE_H
+
+#include <optional>
+#include <string_view>
+
+// Function to parse a numeric CSV field without allocating or consulting the locale.
+// Surrounding spaces, a leading sign and thousands separators ("1,234") are accepted.
+// Suppressed markers such as "*", "**" or "#", blank fields and anything else that is
+// not entirely a finite number (including "-inf" and "-nan") come back empty rather than as 0.0.
+std::optional<double> parseNumber(std::string_view field);
+
+#endif //PROJECT3_NUMBERPARSE_H
@@ -0,0 +1,164 @@
+#include "Queries.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "StringPool.h"
+#include "TopK.h"
+
+std::vector<std::string> searchOccupations(const Dataset& dataset, const std::string& keyword) {
+    std::vector<std::string> matchingTitles;
+    for (std::uint32_t id : dataset.titleIndex.match(keyword)) {
+        matchingTitles.emplace_back(dataset.titleIndex.title(id));
+    }
+    if (matchingTitles.empty()) {
+        for (const TitleMatch& match : dataset.titleIndex.fuzzyMatch(keyword)) {
+            matchingTitles.emplace_back(dataset.titleIndex.title(match.id));
+        }
+    }
+    return matchingTitles;
+}
+
+namespace {
+
+// Average salary for title in each state of the occupation table (by state id), 0 where there is none
+// Titles are looked up by interned id in the salary index; a title that was never loaded matches nothing
+std::vector<float> salaryByState(const std::string& title, const Dataset& dataset) {
+    std::vector<float> advJobSalaryPerState(dataset.occupationTable.states.size(), 0);
+    std::optional<StringId> titleId = stringPool().find(title);
+    const SalaryAggregate* aggregates = titleId ? dataset.salaryIndex.find(*titleId) : nullptr;
+    if (aggregates) {
+        for (std::size_t state = 0; state < dataset.salaryIndex.states(); state++) {
+            advJobSalaryPerState[state] = static_cast<float>(aggregates[state].mean());
+        }
+    }
+    return advJobSalaryPerState;
+}
+
+// Average home value of each state of the house table (by state id), 0 where there is none
+std::vector<float> homeValueByState(const HomeValueStats& homeStats) {
+    std::vector<float> advHomeValuePerState(homeStats.byState.size(), 0);
+    for (std::size_t state = 0; state < homeStats.byState.size(); state++) {
+        const ValueStats& stats = homeStats.byState[state];
+        advHomeValuePerState[state] = (stats.count != 0) ? static_cast<float>(stats.mean) : 0;
+    }
+    return advHomeValuePerState;
+}
+
+// Every state with salary rows is a candidate; one without housing data counts as a home value of 0,
+// and one where nobody holds the title scores 0
+std::vector<PlaceScore> rankStatesBySalary(const std::vector<float>& advJobSalaryPerState, std::size_t numStates,
+                                   const std::vector<float>& homeValues, const Dataset& dataset) {
+    const OccupationTable& occupationTable = dataset.occupationTable;
+    std::vector<std::uint32_t> states(occupationTable.states.size());
+    for (std::uint32_t state = 0; state < states.size(); state++) {
+        states[state] = state;
+    }
+    auto ranked = topK(states.begin(), states.end(), numStates, [&](std::uint32_t state) -> double {
+        float jobSalary = advJobSalaryPerState[state];
+        return (jobSalary != 0) ? static_cast<float>(jobSalary - (homeValues[state]/30.0)) : 0;
+    });
+    std::vector<PlaceScore> places;
+    places.reserve(ranked.size());
+    for (const auto& entry : ranked) {
+        places.push_back({std::string(occupationTable.states.str(entry.item)), std::string(),
+                          advJobSalaryPerState[entry.item], homeValues[entry.item], entry.score});
+    }
+    return places;
+}
+
+}
+
+void printPlace(const PlaceScore& place, std::ostream& out) {
+    if (place.county.empty()) {
+        out << "State: " << place.state << std::endl;
+    } else {
+        out << "County: " << place.county << ", " << place.state << std::endl;
+    }
+    out << "  Average Job Salary: " << place.jobSalary << std::endl;
+    out << "  Average Home Value: " << place.homeValue << std::endl;
+    out << "  Average Monthly Payment: " << (place.homeValue/360.0) << std::endl;
+    out << "  Difference in Job Salary and Yearly Mortgage Payments: " << (place.jobSalary - (place.homeValue/30.0)) << std::endl;
+}
+
+std::optional<std::string> resolveOccupation(const Dataset& dataset, const std::string& text,
+                                             std::vector<std::string>& matches) {
+    matches.clear();
+    if (dataset.occupationNames.count(text) != 0) {
+        return text;
+    }
+    matches = searchOccupations(dataset, text);
+    if (matches.size() == 1) {
+        return matches.front();
+    }
+    return std::nullopt;
+}
+
+std::vector<float> homeValueByOccupationState(const Dataset& dataset) {
+    std::vector<float> advHomeValuePerState = homeValueByState(dataset.homeStats);
+    std::vector<float> homeValues(dataset.occupationTable.states.size(), 0);
+    for (std::uint32_t state = 0; state < homeValues.size(); state++) {
+        std::optional<StringId> houseState = dataset.houseTable.states.find(dataset.occupationTable.states.str(state));
+        homeValues[state] = houseState ? advHomeValuePerState[*houseState] : 0;
+    }
+    return homeValues;
+}
+
+std::vector<PlaceScore> rankStates(const std::string& title, std::size_t numStates,
+                                   const std::vector<float>& homeValues, const Dataset& dataset) {
+    return rankStatesBySalary(salaryByState(title, dataset), numStates, homeValues, dataset);
+}
+
+std::vector<PlaceScore> rankPlaces(const std::string& title, std::size_t numPlaces, Granularity granularity,
+                                   const Dataset& dataset) {
+    const HouseTable& houseTable = dataset.houseTable;
+    const OccupationTable& occupationTable = dataset.occupationTable;
+    std::vector<float> advJobSalaryPerState = salaryByState(title, dataset);
+    if (granularity == Granularity::State) {
+        return rankStatesBySalary(advJobSalaryPerState, numPlaces, homeValueByOccupationState(dataset), dataset);
+    }
+
+    // Counties take the salary of their state; counties in states where nobody holds the title are left out
+    std::vector<float> salaryByHouseState(houseTable.states.size(), 0);
+    for (std::uint32_t state = 0; state < houseTable.states.size(); state++) {
+        std::optional<StringId> occupationState = occupationTable.states.find(houseTable.states.str(state));
+        salaryByHouseState[state] = occupationState ? advJobSalaryPerState[*occupationState] : 0;
+    }
+    const std::vector<PlaceStats>& counties = dataset.homeStats.byCounty;
+    std::vector<PlaceScore> places;
+    auto ranked = topK(counties.begin(), counties.end(), numPlaces, [&](const PlaceStats& county) {
+        double jobSalary = salaryByHouseState[county.state];
+        return (jobSalary != 0) ? jobSalary - county.stats.mean / 30.0 : missingValue;
+    });
+    for (const auto& entry : ranked) {
+        places.push_back({std::string(houseTable.states.str(entry.item.state)),
+                          std::string(stringPool().str(entry.item.name)),
+                          salaryByHouseState[entry.item.state], entry.item.stats.mean, entry.score});
+    }
+    return places;
+}
+
+void top5States(
+        const std::string& title,
+        int numStates,
+        const Dataset& dataset,
+        std::ostream& out
+) {
+    // Select the top states, as many as asked for and as there are
+    for (const PlaceScore& place : rankPlaces(title, static_cast<std::size_t>(std::max(numStates, 0)),
+                                              Granularity::State, dataset)) {
+        printPlace(place, out);
+    }
+}
+
+void topCounties(const std::string& title, int numCounties, const Dataset& dataset, std::ostream& out) {
+    for (const PlaceScore& place : rankPlaces(title, static_cast<std::size_t>(std::max(numCounties, 0)),
+                                              Granularity::County, dataset)) {
+        printPlace(place, out);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef PROJECT3_QUERIES_H
+#define PROJECT3_QUERIES_H
+
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Dataset.h"
+
+// Shared, read-only handle to a loaded dataset. Queries only ever see it through a const
+// reference, so any number of them can run against one load without copying it.
+using DatasetHandle = std::shared_ptr<const Dataset>;
+
+// Function to search the occupation titles: a title matches when every word of keyword starts one
+// of its words, ignoring case ("nur" finds "Registered Nurses"), and those come back in
+// alphabetical order. When nothing matches that way, the titles most similar by trigrams are
+// returned instead, best first, so typos such as "softwre" still find something.
+std::vector<std::string> searchOccupations(const Dataset& dataset, const std::string& keyword);
+
+// Function to pick the title a query given up front means, with nobody to choose from a list: text itself
+// when it is a loaded title, otherwise the one title searchOccupations finds for it. When the search finds
+// none or several, nothing comes back and matches holds what it found.
+std::optional<std::string> resolveOccupation(const Dataset& dataset, const std::string& text,
+                                             std::vector<std::string>& matches);
+
+// Places a title can be ranked over
+enum class Granularity { State, County };
+
+// A state or county ranked for an occupation; county is empty at state granularity
+struct PlaceScore {
+    std::string state;
+    std::string county;
+    double jobSalary;
+    double homeValue;
+    double score;
+};
+
+// Function to rank the best places to live for a title: the numPlaces states or counties with the
+// largest gap between the title's average salary in the state and a year of mortgage payments
+// (average home value / 30), best first. Fewer come back when there are fewer places.
+std::vector<PlaceScore> rankPlaces(const std::string& title, std::size_t numPlaces, Granularity granularity,
+                                   const Dataset& dataset);
+
+// Function returning the average home value of each state of the occupation table (by state id), 0 for a
+// state without housing data. It is the same for every title, so a batch of rankings works it out once.
+std::vector<float> homeValueByOccupationState(const Dataset& dataset);
+
+// Function to rank the numStates best states for title, as rankPlaces does at state granularity,
+// given the home values from homeValueByOccupationState
+std::vector<PlaceScore> rankStates(const std::string& title, std::size_t numStates,
+                                   const std::vector<float>& homeValues, const Dataset& dataset);
+
+// Function to print one ranked place with its salary, home value and yearly mortgage payments
+void printPlace(const PlaceScore& place, std::ostream& out = std::cout);
+
+// Function to find the top numStates best cost of living states
+void top5States(const std::string& title, int numStates, const Dataset& dataset, std::ostream& out = std::cout);
+
+// Function to find the top numCounties best cost of living counties
+void topCounties(const std::string& title, int numCounties, const Dataset& dataset, std::ostream& out = std::cout);
+
+#endif //PROJECT3_QUERIES_H
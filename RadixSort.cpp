@@ -0,0 +1,70 @@
+#include "RadixSort.h"
+
+#include <cstring>
+
+namespace {
+
+const int radixBits = 8;
+const int radixPasses = 64 / radixBits;
+const std::size_t radixBuckets = std::size_t(1) << radixBits;
+
+struct KeyIndex {
+    std::uint64_t key;
+    std::uint32_t index;
+};
+
+inline std::size_t digit(std::uint64_t key, int pass) {
+    return static_cast<std::size_t>(key >> (pass * radixBits)) & (radixBuckets - 1);
+}
+
+}
+
+std::uint64_t radixKey(double value) {
+    const std::uint64_t signBit = std::uint64_t(1) << 63;
+    if (isMissing(value)) {
+        return ~std::uint64_t(0);
+    }
+    if (value == 0.0) {
+        value = 0.0;
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Negative doubles order backwards as integers, so flip all their bits; positives just gain the sign bit
+    return (bits & signBit) ? ~bits : bits | signBit;
+}
+
+void radixSortPermutation(const double* keys, std::size_t count, std::vector<std::uint32_t>& order) {
+    std::vector<KeyIndex> items(count);
+    std::vector<std::size_t> counts(radixPasses * radixBuckets, 0);
+    // One read of the keys builds the histograms for every pass
+    for (std::size_t i = 0; i < count; i++) {
+        std::uint64_t key = radixKey(keys[i]);
+        items[i] = {key, static_cast<std::uint32_t>(i)};
+        for (int pass = 0; pass < radixPasses; pass++) {
+            counts[pass * radixBuckets + digit(key, pass)]++;
+        }
+    }
+
+    std::vector<KeyIndex> buffer(count);
+    for (int pass = 0; pass < radixPasses && count > 0; pass++) {
+        std::size_t* bucket = &counts[pass * radixBuckets];
+        if (bucket[digit(items[0].key, pass)] == count) {
+            continue;
+        }
+        std::size_t offset = 0;
+        for (std::size_t b = 0; b < radixBuckets; b++) {
+            std::size_t size = bucket[b];
+            bucket[b] = offset;
+            offset += size;
+        }
+        for (const KeyIndex& item : items) {
+            buffer[bucket[digit(item.key, pass)]++] = item;
+        }
+        items.swap(buffer);
+    }
+
+    order.resize(count);
+    for (std::size_t i = 0; i < count; i++) {
+        order[i] = items[i].index;
+    }
+}
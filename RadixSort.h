@@ -0,0 +1,55 @@
+#ifndef PROJECT3_RADIXSORT_H
+#define PROJECT3_RADIXSORT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "Records.h"
+
+// Function that maps a double to an unsigned key whose integer order matches valueLess:
+// negatives below positives, -0.0 folded into 0.0, and every NaN (missing value) above +inf
+std::uint64_t radixKey(double value);
+
+// Function to LSD radix sort count keys, one byte per pass, and fill order with the indices
+// of keys in ascending valueLess order. The sort is stable, so equal keys keep their input
+// order, and passes where every key has the same byte are skipped. count must fit in 32 bits.
+void radixSortPermutation(const double* keys, std::size_t count, std::vector<std::uint32_t>& order);
+
+// Function to radix sort one vector of records by sortKey, moving each record once
+template <typename T>
+void radixSort(std::pmr::vector<T>& records) {
+    std::vector<double> keys;
+    keys.reserve(records.size());
+    for (const T& record : records) {
+        keys.push_back(sortKey(record));
+    }
+    std::vector<std::uint32_t> order;
+    radixSortPermutation(keys.data(), keys.size(), order);
+
+    std::pmr::vector<T> sorted(records.get_allocator());
+    sorted.reserve(records.size());
+    for (std::uint32_t index : order) {
+        sorted.push_back(std::move(records[index]));
+    }
+    records.swap(sorted);
+}
+
+// Define a template function for radix sorting, timed like shellSortData and quickSortTop
+template <typename T>
+void radixSortData(StateMap<T>& data) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (auto& entry : data) {
+        radixSort(entry.second);
+    }
+
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    std::cout << "Radix Sort Time in Milliseconds: " << duration.count() / 1000.0 << std::endl;
+}
+
+#endif //PROJECT3_RADIXSORT_H
@@ -0,0 +1,94 @@
+#ifndef PROJECT3_RECORDS_H
+#define PROJECT3_RECORDS_H
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "StringPool.h"
+
+// Blank or suppressed numeric fields ("*", "#") are stored as NaN
+constexpr double missingValue = std::numeric_limits<double>::quiet_NaN();
+
+inline bool isMissing(double value) {
+    return std::isnan(value);
+}
+
+// Ordering used by the record comparisons: numbers ascending, missing values after all of them
+inline bool valueLess(double a, double b) {
+    if (isMissing(a)) {
+        return false;
+    }
+    return isMissing(b) || a < b;
+}
+
+// Class representing an occupation with relevant information
+// Text fields are ids into stringPool()
+class Occupation {
+public:
+    StringId AREA;
+    StringId PRIM_STATE;
+    StringId OCC_TITLE;
+    double TOT_EMP;
+    double A_MEAN;
+
+    bool operator>(const Occupation& other) const{
+        return valueLess(other.A_MEAN, A_MEAN);
+    }
+
+    bool operator<(const Occupation& other) const{
+        return valueLess(A_MEAN, other.A_MEAN);
+    }
+
+    Occupation(StringId area, StringId prim_state, StringId occ_title, double tot_emp, double a_mean)
+            : AREA(area), PRIM_STATE(prim_state), OCC_TITLE(occ_title), TOT_EMP(tot_emp), A_MEAN(a_mean) {}
+
+    Occupation() : AREA(0), PRIM_STATE(0), OCC_TITLE(0), TOT_EMP(0.0), A_MEAN(0.0) {}
+};
+
+// Class representing information about a zip code, including home cost and associated occupations
+// Text fields are ids into stringPool()
+class HouseInfo {
+public:
+    StringId RegionID;
+    StringId State;
+    StringId City;
+    StringId CountyName;
+    double MeanValue;
+
+    HouseInfo(StringId regionID, StringId state, StringId city, StringId countyName, double meanValue)
+            : RegionID(regionID), State(state), City(city), CountyName(countyName), MeanValue(meanValue) {}
+
+    HouseInfo(double cost = 0.0) : RegionID(0), State(0), City(0), CountyName(0), MeanValue(cost) {}
+
+    bool operator>(const HouseInfo& other) const{
+        return valueLess(other.MeanValue, MeanValue);
+    }
+
+    bool operator<(const HouseInfo& other) const{
+        return valueLess(MeanValue, other.MeanValue);
+    }
+
+};
+
+// Sort key of each record type: the value its operator< orders by
+inline double sortKey(const Occupation& record) {
+    return record.A_MEAN;
+}
+
+inline double sortKey(const HouseInfo& record) {
+    return record.MeanValue;
+}
+
+// Records grouped by two letter state code. The containers take a memory resource so a
+// Dataset can place every node and record vector of a load in its arena.
+template <typename T>
+using StateMap = std::pmr::map<std::string, std::pmr::vector<T>>;
+
+using HouseMap = StateMap<HouseInfo>;
+using OccupationMap = StateMap<Occupation>;
+
+#endif //PROJECT3_RECORDS_H
@@ -0,0 +1,843 @@
+#include "Server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+#include "Aggregates.h"
+#include "Batch.h"
+#include "CommandLine.h"
+#include "Queries.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Largest number of places one request may ask for
+const std::size_t maxTop = 1000;
+
+void skipSpace(std::string_view text, std::size_t& at) {
+    while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\r' || text[at] == '\n')) {
+        at++;
+    }
+}
+
+// Appends code point as UTF-8
+void appendUtf8(std::uint32_t code, std::string& out) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Reads the JSON string starting at the quote at text[at], leaving at just past its closing quote.
+// Escaped surrogate pairs are not combined; each half becomes U+FFFD.
+bool parseJsonString(std::string_view text, std::size_t& at, std::string& value) {
+    if (at >= text.size() || text[at] != '"') {
+        return false;
+    }
+    value.clear();
+    for (at++; at < text.size(); at++) {
+        char c = text[at];
+        if (c == '"') {
+            at++;
+            return true;
+        }
+        if (c != '\\') {
+            value += c;
+            continue;
+        }
+        if (++at >= text.size()) {
+            return false;
+        }
+        switch (text[at]) {
+            case '"':
+            case '\\':
+            case '/':
+                value += text[at];
+                break;
+            case 'b':
+                value += '\b';
+                break;
+            case 'f':
+                value += '\f';
+                break;
+            case 'n':
+                value += '\n';
+                break;
+            case 'r':
+                value += '\r';
+                break;
+            case 't':
+                value += '\t';
+                break;
+            case 'u': {
+                if (at + 4 >= text.size()) {
+                    return false;
+                }
+                std::uint32_t code = 0;
+                for (int digit = 1; digit <= 4; digit++) {
+                    char h = text[at + digit];
+                    code <<= 4;
+                    if (h >= '0' && h <= '9') {
+                        code |= static_cast<std::uint32_t>(h - '0');
+                    } else if (h >= 'a' && h <= 'f') {
+                        code |= static_cast<std::uint32_t>(h - 'a' + 10);
+                    } else if (h >= 'A' && h <= 'F') {
+                        code |= static_cast<std::uint32_t>(h - 'A' + 10);
+                    } else {
+                        return false;
+                    }
+                }
+                appendUtf8((code >= 0xD800 && code <= 0xDFFF) ? 0xFFFD : code, value);
+                at += 4;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+// Parses a JSON object whose values are all strings, numbers, true, false or null into fields.
+// Strings are unescaped; anything else is kept as its text.
+bool parseFlatObject(std::string_view text, std::map<std::string, std::string>& fields, std::string& error) {
+    std::size_t at = 0;
+    skipSpace(text, at);
+    if (at >= text.size() || text[at] != '{') {
+        error = "request is not a JSON object";
+        return false;
+    }
+    at++;
+    skipSpace(text, at);
+    if (at < text.size() && text[at] == '}') {
+        at++;
+    } else {
+        while (true) {
+            std::string key, value;
+            skipSpace(text, at);
+            if (!parseJsonString(text, at, key)) {
+                error = "expected a quoted key";
+                return false;
+            }
+            skipSpace(text, at);
+            if (at >= text.size() || text[at] != ':') {
+                error = "expected ':' after \"" + key + "\"";
+                return false;
+            }
+            at++;
+            skipSpace(text, at);
+            if (at < text.size() && text[at] == '"') {
+                if (!parseJsonString(text, at, value)) {
+                    error = "unterminated string for \"" + key + "\"";
+                    return false;
+                }
+            } else if (at < text.size() && (text[at] == '{' || text[at] == '[')) {
+                error = "\"" + key + "\" must be a string or a number";
+                return false;
+            } else {
+                std::size_t end = text.find_first_of(",} \t\r\n", at);
+                end = (end == std::string_view::npos) ? text.size() : end;
+                value = std::string(text.substr(at, end - at));
+                at = end;
+                if (value.empty()) {
+                    error = "missing value for \"" + key + "\"";
+                    return false;
+                }
+            }
+            fields[key] = value;
+            skipSpace(text, at);
+            if (at < text.size() && text[at] == ',') {
+                at++;
+                continue;
+            }
+            if (at < text.size() && text[at] == '}') {
+                at++;
+                break;
+            }
+            error = "expected ',' or '}'";
+            return false;
+        }
+    }
+    skipSpace(text, at);
+    if (at != text.size()) {
+        error = "unexpected text after the object";
+        return false;
+    }
+    return true;
+}
+
+bool parseTop(const std::string& text, std::size_t& top) {
+    std::size_t value = 0;
+    if (!parseCount(text, value) || value > maxTop) {
+        return false;
+    }
+    top = value;
+    return true;
+}
+
+void writeJsonNumber(double value, std::ostream& out) {
+    if (std::isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+std::string errorResponse(const std::string& message, const std::vector<std::string>& matches = {}) {
+    std::ostringstream out;
+    out << "{\"ok\": false, \"error\": ";
+    writeJsonString(message, out);
+    if (!matches.empty()) {
+        out << ", \"matches\": [";
+        for (std::size_t i = 0; i < matches.size(); i++) {
+            out << (i == 0 ? "" : ", ");
+            writeJsonString(matches[i], out);
+        }
+        out << "]";
+    }
+    out << "}";
+    return out.str();
+}
+
+}
+
+std::string answerRequest(const Dataset& dataset, std::string_view request) {
+    std::map<std::string, std::string> fields;
+    std::string error;
+    if (!parseFlatObject(request, fields, error)) {
+        return errorResponse(error);
+    }
+    auto field = [&fields](const std::string& key, const std::string& fallback) {
+        auto found = fields.find(key);
+        return found != fields.end() ? found->second : fallback;
+    };
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    std::string op = field("op", "rank");
+    if (op == "titles") {
+        out << "{\"ok\": true, \"titles\": [";
+        bool first = true;
+        for (std::string_view title : dataset.occupationNames) {
+            out << (first ? "" : ", ");
+            writeJsonString(title, out);
+            first = false;
+        }
+        out << "]}";
+        return out.str();
+    }
+    if (op != "rank") {
+        return errorResponse("unknown op \"" + op + "\"");
+    }
+
+    std::string occupation = field("occupation", "");
+    if (occupation.empty()) {
+        return errorResponse("\"occupation\" is required");
+    }
+    std::size_t top = 5;
+    if (fields.count("top") != 0 && !parseTop(fields["top"], top)) {
+        return errorResponse("\"top\" must be a whole number from 1 to " + std::to_string(maxTop));
+    }
+    std::string by = field("by", "state");
+    if (by != "state" && by != "county") {
+        return errorResponse("\"by\" must be \"state\" or \"county\"");
+    }
+
+    std::vector<std::string> matches;
+    std::optional<std::string> title = resolveOccupation(dataset, occupation, matches);
+    if (!title) {
+        return matches.empty() ? errorResponse("no occupation matches \"" + occupation + "\"")
+                               : errorResponse("several occupations match \"" + occupation + "\"", matches);
+    }
+    Granularity granularity = (by == "county") ? Granularity::County : Granularity::State;
+    std::vector<PlaceScore> places = rankPlaces(*title, top, granularity, dataset);
+
+    out << "{\"ok\": true, \"title\": ";
+    writeJsonString(*title, out);
+    out << ", \"by\": \"" << by << "\", \"places\": [";
+    for (std::size_t rank = 0; rank < places.size(); rank++) {
+        const PlaceScore& place = places[rank];
+        out << (rank == 0 ? "" : ", ") << "{\"rank\": " << rank + 1 << ", \"state\": ";
+        writeJsonString(place.state, out);
+        if (granularity == Granularity::County) {
+            out << ", \"county\": ";
+            writeJsonString(place.county, out);
+        }
+        out << ", \"jobSalary\": ";
+        writeJsonNumber(place.jobSalary, out);
+        out << ", \"homeValue\": ";
+        writeJsonNumber(place.homeValue, out);
+        out << ", \"score\": ";
+        writeJsonNumber(place.score, out);
+        out << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+#ifdef __linux__
+
+namespace {
+
+// epoll ids of the server's own descriptors; connections are numbered after them
+const std::uint64_t listenId = 0;
+const std::uint64_t wakeId = 1;
+const std::uint64_t stopId = 2;
+const std::uint64_t firstConnectionId = 3;
+
+// A connection that sends this much without a newline is answered with an error and closed
+const std::size_t maxRequestBytes = 64 * 1024;
+
+// A connection stops being read while this much of its output is unsent or this many of its requests are
+// waiting, so a client that pipelines without reading its answers cannot grow the server without bound;
+// reading resumes once it drains
+const std::size_t maxPendingOutputBytes = 64 * 1024;
+const std::size_t maxPendingRequests = 64;
+
+// Descriptor the signal handler writes to; a write is all a handler may safely do
+int signalStopFd = -1;
+
+void signalEvent(int fd) {
+    std::uint64_t one = 1;
+    ssize_t written = ::write(fd, &one, sizeof(one));
+    (void) written;
+}
+
+void onStopSignal(int) {
+    if (signalStopFd >= 0) {
+        signalEvent(signalStopFd);
+    }
+}
+
+}
+
+QueryServer::QueryServer(const Dataset& dataset, ThreadPool& pool)
+        : dataset(dataset), pool(pool), nextId(firstConnectionId) {
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    stopFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+QueryServer::~QueryServer() {
+    for (auto& entry : connections) {
+        ::close(entry.second.fd);
+    }
+    if (signalStopFd == stopFd) {
+        signalStopFd = -1;
+    }
+    for (int fd : {listenFd, epollFd, wakeFd, stopFd}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (listenFd >= 0) {
+        ::unlink(socketPath.c_str());
+    }
+}
+
+bool QueryServer::listen(const std::string& path, std::string& error) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        error = "socket path must be 1 to " + std::to_string(sizeof(address.sun_path) - 1) + " characters";
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    if (wakeFd < 0 || stopFd < 0) {
+        error = std::string("eventfd: ") + std::strerror(errno);
+        return false;
+    }
+
+    // A socket left behind by a server that is gone is replaced; a live one or any other file is left alone
+    struct stat info;
+    if (::lstat(path.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            error = path + " exists and is not a socket";
+            return false;
+        }
+        int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (live) {
+            error = "a server is already listening on " + path;
+            return false;
+        }
+        ::unlink(path.c_str());
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        error = path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    listenFd = fd;
+    socketPath = path;
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        error = std::string("epoll_create1: ") + std::strerror(errno);
+        return false;
+    }
+    for (std::pair<int, std::uint64_t> source : {std::make_pair(listenFd, listenId), std::make_pair(wakeFd, wakeId),
+                                                 std::make_pair(stopFd, stopId)}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = source.second;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, source.first, &event) != 0) {
+            error = std::string("epoll_ctl: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+void QueryServer::run() {
+    if (epollFd < 0) {
+        return;
+    }
+    std::vector<epoll_event> events(64);
+    bool stopping = false;
+    while (!stopping) {
+        int count = ::epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            std::uint64_t id = events[i].data.u64;
+            if (id == listenId) {
+                acceptConnections();
+            } else if (id == wakeId) {
+                collectCompletions();
+            } else if (id == stopId) {
+                stopping = true;
+            } else {
+                auto found = connections.find(id);
+                if (found == connections.end()) {
+                    continue;
+                }
+                Connection& connection = found->second;
+                if ((events[i].events & EPOLLOUT) && !flush(id, connection)) {
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    readConnection(id, connection);
+                }
+            }
+        }
+    }
+
+    // Tasks still on the pool hold a reference to this server, so their answers are waited for
+    while (inFlight > 0) {
+        int count = ::epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 100);
+        if (count < 0 && errno != EINTR) {
+            break;
+        }
+        collectCompletions();
+    }
+}
+
+void QueryServer::stop() {
+    if (stopFd >= 0) {
+        signalEvent(stopFd);
+    }
+}
+
+void QueryServer::stopOnSignals() {
+    signalStopFd = stopFd;
+    struct sigaction action{};
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+}
+
+void QueryServer::acceptConnections() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN once the backlog is empty; anything else (such as running out of descriptors)
+            // leaves the rest of the backlog for the next wakeup
+            return;
+        }
+        std::uint64_t id = nextId++;
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = id;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        Connection& connection = connections[id];
+        connection.fd = fd;
+        connection.watched = event.events;
+    }
+}
+
+void QueryServer::readConnection(std::uint64_t id, Connection& connection) {
+    char buffer[16 * 1024];
+    while (!backlogged(connection)) {
+        ssize_t got = ::read(connection.fd, buffer, sizeof(buffer));
+        if (got > 0) {
+            connection.input.append(buffer, static_cast<std::size_t>(got));
+            splitRequests(connection);
+            if (connection.input.size() > maxRequestBytes) {
+                break;
+            }
+            continue;
+        }
+        if (got == 0) {
+            connection.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            close(id);
+            return;
+        }
+        break;
+    }
+
+    if (connection.input.size() > maxRequestBytes) {
+        connection.output += errorResponse("request longer than " + std::to_string(maxRequestBytes) + " bytes");
+        connection.output += '\n';
+        connection.input.clear();
+        connection.requests.clear();
+        connection.peerClosed = true;
+    } else if (connection.peerClosed && !connection.input.empty()) {
+        // The last request of a client that closed without a final newline
+        connection.requests.push_back(std::move(connection.input));
+        connection.input.clear();
+    }
+    dispatch(id, connection);
+    flush(id, connection);
+}
+
+void QueryServer::splitRequests(Connection& connection) {
+    std::size_t start = 0, newline;
+    while ((newline = connection.input.find('\n', start)) != std::string::npos) {
+        std::string line = connection.input.substr(start, newline - start);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            connection.requests.push_back(std::move(line));
+        }
+        start = newline + 1;
+    }
+    connection.input.erase(0, start);
+}
+
+bool QueryServer::backlogged(const Connection& connection) {
+    return connection.output.size() >= maxPendingOutputBytes || connection.requests.size() >= maxPendingRequests;
+}
+
+void QueryServer::dispatch(std::uint64_t id, Connection& connection) {
+    if (connection.busy || connection.requests.empty()) {
+        return;
+    }
+    connection.busy = true;
+    inFlight++;
+    std::string request = std::move(connection.requests.front());
+    connection.requests.pop_front();
+    pool.submit([this, id, request]() {
+        std::string response = answerRequest(dataset, request);
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completions.push_back({id, std::move(response)});
+        }
+        signalEvent(wakeFd);
+    });
+}
+
+void QueryServer::collectCompletions() {
+    std::uint64_t count = 0;
+    ssize_t got = ::read(wakeFd, &count, sizeof(count));
+    (void) got;
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        done.swap(completions);
+    }
+    for (Completion& completion : done) {
+        inFlight--;
+        served++;
+        auto found = connections.find(completion.connection);
+        if (found == connections.end()) {
+            continue;
+        }
+        Connection& connection = found->second;
+        connection.busy = false;
+        connection.output += completion.response;
+        connection.output += '\n';
+        dispatch(completion.connection, connection);
+        flush(completion.connection, connection);
+    }
+}
+
+bool QueryServer::flush(std::uint64_t id, Connection& connection) {
+    std::size_t sent = 0;
+    while (sent < connection.output.size()) {
+        ssize_t wrote = ::send(connection.fd, connection.output.data() + sent, connection.output.size() - sent,
+                               MSG_NOSIGNAL);
+        if (wrote > 0) {
+            sent += static_cast<std::size_t>(wrote);
+            continue;
+        }
+        if (wrote < 0 && errno == EINTR) {
+            continue;
+        }
+        if (wrote < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        close(id);
+        return false;
+    }
+    connection.output.erase(0, sent);
+
+    // A client that has closed its side is let go once everything it asked for has been answered
+    if (connection.peerClosed && !connection.busy && connection.requests.empty() && connection.output.empty()) {
+        close(id);
+        return false;
+    }
+
+    // Reading stops once the peer has closed its side, so a hung-up socket does not keep waking the loop
+    // while its last answer is on the pool, and while the connection is backlogged; the loop is level
+    // triggered, so unread requests are reported again once reading is re-armed. Writing is watched only
+    // while output is waiting
+    bool reading = !connection.peerClosed && !backlogged(connection);
+    std::uint32_t readEvents = reading ? static_cast<std::uint32_t>(EPOLLIN | EPOLLRDHUP) : 0;
+    std::uint32_t writing = connection.output.empty() ? 0 : static_cast<std::uint32_t>(EPOLLOUT);
+    std::uint32_t wanted = readEvents | writing;
+    if (wanted != connection.watched) {
+        epoll_event event{};
+        event.events = wanted;
+        event.data.u64 = id;
+        int op = (wanted == 0) ? EPOLL_CTL_DEL : (connection.watched == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD);
+        ::epoll_ctl(epollFd, op, connection.fd, &event);
+        connection.watched = wanted;
+    }
+    return true;
+}
+
+void QueryServer::close(std::uint64_t id) {
+    auto found = connections.find(id);
+    if (found == connections.end()) {
+        return;
+    }
+    // Closing the descriptor also takes it out of the epoll set
+    ::close(found->second.fd);
+    connections.erase(found);
+}
+
+namespace {
+
+int connectTo(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t wrote = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (wrote < 0 && errno == EINTR) {
+            continue;
+        }
+        if (wrote <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(wrote);
+    }
+    return true;
+}
+
+// Reads up to the next newline into line, keeping anything after it in buffer for the next call
+bool readLine(int fd, std::string& buffer, std::string& line) {
+    std::size_t newline;
+    while ((newline = buffer.find('\n')) == std::string::npos) {
+        char chunk[16 * 1024];
+        ssize_t got = ::read(fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(got));
+    }
+    line.assign(buffer, 0, newline);
+    buffer.erase(0, newline + 1);
+    return true;
+}
+
+// Pulls the list out of a {"ok": true, "titles": [...]} response
+bool parseTitles(std::string_view response, std::vector<std::string>& titles) {
+    const std::string_view key = "\"titles\": [";
+    std::size_t at = response.find(key);
+    if (at == std::string_view::npos) {
+        return false;
+    }
+    at += key.size();
+    std::string title;
+    while (true) {
+        skipSpace(response, at);
+        if (at < response.size() && response[at] == ']') {
+            return true;
+        }
+        if (!parseJsonString(response, at, title)) {
+            return false;
+        }
+        titles.push_back(title);
+        skipSpace(response, at);
+        if (at < response.size() && response[at] == ',') {
+            at++;
+        }
+    }
+}
+
+}
+
+bool runLoadTest(const std::string& socketPath, std::size_t clients, std::size_t requests, LoadReport& report,
+                 std::string& error) {
+    report = LoadReport();
+    clients = std::max<std::size_t>(clients, 1);
+    std::vector<std::string> titles;
+    int fd = connectTo(socketPath);
+    if (fd < 0) {
+        error = socketPath + ": " + std::strerror(errno);
+        return false;
+    }
+    std::string buffer, line;
+    bool listed = sendAll(fd, "{\"op\": \"titles\"}\n") && readLine(fd, buffer, line) && parseTitles(line, titles);
+    ::close(fd);
+    if (!listed || titles.empty()) {
+        error = "could not read the titles from " + socketPath;
+        return false;
+    }
+
+    // Requests are built up front so the clients only time the round trips
+    std::vector<std::string> mix;
+    for (std::size_t i = 0; i < titles.size() * 4; i++) {
+        std::ostringstream request;
+        request << "{\"occupation\": ";
+        writeJsonString(titles[i % titles.size()], request);
+        request << ", \"top\": 5, \"by\": \"" << (i % 4 == 3 ? "county" : "state") << "\"}\n";
+        mix.push_back(request.str());
+    }
+
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<std::size_t> errors(clients, 0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t client = 0; client < clients; client++) {
+        std::size_t share = requests / clients + (client < requests % clients ? 1 : 0);
+        threads.emplace_back([&, client, share]() {
+            int connection = connectTo(socketPath);
+            if (connection < 0) {
+                errors[client] = share;
+                return;
+            }
+            std::string pending, response;
+            latencies[client].reserve(share);
+            for (std::size_t k = 0; k < share; k++) {
+                const std::string& request = mix[(client * 7919 + k) % mix.size()];
+                auto sent = std::chrono::steady_clock::now();
+                if (!sendAll(connection, request) || !readLine(connection, pending, response)) {
+                    errors[client] += share - k;
+                    break;
+                }
+                auto answered = std::chrono::steady_clock::now();
+                latencies[client].push_back(std::chrono::duration<double, std::milli>(answered - sent).count());
+                if (response.compare(0, 12, "{\"ok\": true,") != 0) {
+                    errors[client]++;
+                }
+            }
+            ::close(connection);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    for (std::size_t client = 0; client < clients; client++) {
+        all.insert(all.end(), latencies[client].begin(), latencies[client].end());
+        report.errors += errors[client];
+    }
+    std::sort(all.begin(), all.end());
+    report.requests = all.size();
+    report.p50Ms = percentile(all, 0.50);
+    report.p99Ms = percentile(all, 0.99);
+    report.maxMs = all.empty() ? 0.0 : all.back();
+    return true;
+}
+
+#else
+
+QueryServer::QueryServer(const Dataset& dataset, ThreadPool& pool) : dataset(dataset), pool(pool) {}
+
+QueryServer::~QueryServer() = default;
+
+bool QueryServer::listen(const std::string&, std::string& error) {
+    error = "the query server needs Linux (epoll and Unix domain sockets)";
+    return false;
+}
+
+void QueryServer::run() {}
+
+void QueryServer::stop() {}
+
+void QueryServer::stopOnSignals() {}
+
+bool runLoadTest(const std::string&, std::size_t, std::size_t, LoadReport&, std::string& error) {
+    error = "the load test needs Linux (Unix domain sockets)";
+    return false;
+}
+
+#endif
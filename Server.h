@@ -0,0 +1,120 @@
+#ifndef PROJECT3_SERVER_H
+#define PROJECT3_SERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Dataset.h"
+#include "ThreadPool.h"
+
+// Function to answer one request line of the server protocol with one response line (without the newline).
+// Requests are flat JSON objects:
+//   {"op": "rank", "occupation": "Registered Nurses", "top": 5, "by": "state"}
+//     ranks the best states (or with "by": "county", counties) for a title, or for the one title a keyword
+//     finds; "op" defaults to "rank", "top" to 5 and "by" to "state"
+//   {"op": "titles"}
+//     lists every loaded title
+// Responses carry "ok": true with the results, or "ok": false with an "error" and, for a keyword that
+// finds several titles, their "matches".
+std::string answerRequest(const Dataset& dataset, std::string_view request);
+
+// Class serving answerRequest over a Unix domain socket, one request per line. A single thread runs an
+// epoll loop that accepts connections and reads and writes them without blocking; each complete request
+// is answered on the pool and the response handed back to the loop through an eventfd. A connection has
+// at most one request on the pool at a time, so pipelined requests are answered in order, and is not read
+// while it has too many answers unsent or requests waiting.
+// Only available on Linux; elsewhere listen fails.
+class QueryServer {
+public:
+    QueryServer(const Dataset& dataset, ThreadPool& pool);
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Binds the socket at path, replacing a stale one, returns false with a message in error on failure
+    bool listen(const std::string& path, std::string& error);
+
+    // Serves connections until stop is called, then waits for requests still on the pool
+    void run();
+
+    // Makes run return; safe to call from any thread and from a signal handler
+    void stop();
+
+    // Stops the server on SIGINT and SIGTERM
+    void stopOnSignals();
+
+    std::size_t requestsServed() const { return served.load(); }
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string input;
+        std::deque<std::string> requests;
+        std::string output;
+        bool busy = false;
+        bool peerClosed = false;
+        // epoll events currently registered for fd, 0 when it is out of the set
+        std::uint32_t watched = 0;
+    };
+
+    struct Completion {
+        std::uint64_t connection;
+        std::string response;
+    };
+
+    void acceptConnections();
+    void readConnection(std::uint64_t id, Connection& connection);
+    // Moves each complete line of input onto the connection's requests
+    static void splitRequests(Connection& connection);
+    // True while the connection has too much unsent output or too many waiting requests to read more
+    static bool backlogged(const Connection& connection);
+    void dispatch(std::uint64_t id, Connection& connection);
+    void collectCompletions();
+    // Returns false once the connection has been closed
+    bool flush(std::uint64_t id, Connection& connection);
+    void close(std::uint64_t id);
+
+    const Dataset& dataset;
+    ThreadPool& pool;
+    std::string socketPath;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    int stopFd = -1;
+
+    std::unordered_map<std::uint64_t, Connection> connections;
+    std::uint64_t nextId = 0;
+    std::size_t inFlight = 0;
+
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+    std::atomic<std::size_t> served{0};
+};
+
+// Results of a load test: every request's round trip, with the percentiles in milliseconds
+struct LoadReport {
+    std::size_t requests = 0;
+    std::size_t errors = 0;
+    double seconds = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+
+    double queriesPerSecond() const { return seconds > 0 ? requests / seconds : 0.0; }
+};
+
+// Function to load a server at socketPath from clients connections at once, each sending its share of
+// requests one after another and timing every round trip. The titles come from the server; every fourth
+// query ranks counties, the rest states. Returns false with a message in error if the server cannot be reached.
+bool runLoadTest(const std::string& socketPath, std::size_t clients, std::size_t requests, LoadReport& report,
+                 std::string& error);
+
+#endif //PROJECT3_SERVER_H
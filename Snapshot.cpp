@@ -0,0 +1,523 @@
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CsvLoader.h"
+#include "StringPool.h"
+
+namespace {
+
+const char snapshotMagic[8] = {'P', '3', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+// Sizes of the structs copied as raw bytes, so a snapshot from a build with a different layout is refused
+const std::uint32_t snapshotLayout = static_cast<std::uint32_t>(sizeof(HouseInfo)) |
+                                     static_cast<std::uint32_t>(sizeof(Occupation)) << 8 |
+                                     static_cast<std::uint32_t>(sizeof(ValueStats)) << 16 |
+                                     static_cast<std::uint32_t>(sizeof(SalaryAggregate)) << 24;
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t layout;
+    SourceFingerprint house;
+    SourceFingerprint occupation;
+    std::uint64_t payloadSize;
+    std::uint64_t payloadChecksum;
+};
+
+}
+
+// Appends values to an in-memory payload; arrays are written as a count followed by their raw bytes
+class SnapshotWriter {
+public:
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as bytes");
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T, typename Allocator>
+    void putArray(const std::vector<T, Allocator>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as bytes");
+        put<std::uint64_t>(values.size());
+        buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void putString(std::string_view value) {
+        put<std::uint64_t>(value.size());
+        buffer.append(value.data(), value.size());
+    }
+
+    const std::string& bytes() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+// Reads values back in the order they were written; every read is bounds checked and fails
+// rather than running past the end of a truncated or corrupt payload
+class SnapshotReader {
+public:
+    SnapshotReader(const char* begin, const char* end) : cursor(begin), last(end) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<std::size_t>(last - cursor) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    template <typename T, typename Allocator>
+    bool getArray(std::vector<T, Allocator>& values) {
+        std::uint64_t count = 0;
+        if (!get(count) || count > static_cast<std::size_t>(last - cursor) / sizeof(T)) {
+            return false;
+        }
+        values.resize(count);
+        std::memcpy(values.data(), cursor, count * sizeof(T));
+        cursor += count * sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string_view& value) {
+        std::uint64_t size = 0;
+        if (!get(size) || size > static_cast<std::size_t>(last - cursor)) {
+            return false;
+        }
+        value = std::string_view(cursor, size);
+        cursor += size;
+        return true;
+    }
+
+    bool atEnd() const { return cursor == last; }
+    std::size_t remaining() const { return static_cast<std::size_t>(last - cursor); }
+
+private:
+    const char* cursor;
+    const char* last;
+};
+
+// Reads and writes the parts of the dataset whose members are private to their classes
+class SnapshotCodec {
+public:
+    static void write(SnapshotWriter& writer, const SalaryIndex& index) {
+        writer.put<std::uint64_t>(index.stateCount);
+        std::vector<StringId> titles(index.titleSlots.size());
+        for (const auto& slot : index.titleSlots) {
+            titles[slot.second] = slot.first;
+        }
+        writer.putArray(titles);
+        writer.putArray(index.aggregates);
+    }
+
+    // Reads the index without its title slots: the stored title ids come back in titles, to be
+    // checked and mapped to this run's ids before setTitles
+    static bool read(SnapshotReader& reader, SalaryIndex& index, std::vector<StringId>& titles) {
+        std::uint64_t stateCount = 0;
+        if (!reader.get(stateCount) || !reader.getArray(titles) || !reader.getArray(index.aggregates) ||
+            index.aggregates.size() != titles.size() * stateCount) {
+            return false;
+        }
+        index.stateCount = static_cast<std::size_t>(stateCount);
+        return true;
+    }
+
+    // Gives title slot i to titles[i]; returns false if a title turns up twice
+    static bool setTitles(SalaryIndex& index, const std::vector<StringId>& titles) {
+        index.titleSlots.reserve(titles.size());
+        for (std::uint32_t slot = 0; slot < titles.size(); slot++) {
+            if (!index.titleSlots.emplace(titles[slot], slot).second) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+namespace {
+
+template <typename T>
+void writeStates(SnapshotWriter& writer, const StateMap<T>& data) {
+    writer.put<std::uint64_t>(data.size());
+    for (const auto& entry : data) {
+        writer.putString(entry.first);
+        writer.putArray(entry.second);
+    }
+}
+
+template <typename T>
+bool readStates(SnapshotReader& reader, StateMap<T>& data) {
+    std::uint64_t count = 0;
+    if (!reader.get(count)) {
+        return false;
+    }
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::string_view state;
+        if (!reader.getString(state) || !reader.getArray(data[std::string(state)])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeDictionary(SnapshotWriter& writer, const StringDictionary& dictionary) {
+    writer.put<std::uint64_t>(dictionary.size());
+    for (StringId id = 0; id < dictionary.size(); id++) {
+        writer.putString(dictionary.str(id));
+    }
+}
+
+bool readDictionary(SnapshotReader& reader, StringDictionary& dictionary) {
+    std::uint64_t count = 0;
+    if (!reader.get(count)) {
+        return false;
+    }
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::string_view value;
+        if (!reader.getString(value)) {
+            return false;
+        }
+        dictionary.intern(value);
+    }
+    // A repeated string would leave the dictionary short of the ids stored against it
+    return dictionary.size() == count;
+}
+
+void writePayload(SnapshotWriter& writer, const Dataset& dataset) {
+    // Every interned string, in id order, so the ids stored below can be mapped back
+    const StringPool& strings = stringPool();
+    std::size_t stringCount = strings.size();
+    writer.put<std::uint64_t>(stringCount);
+    for (StringId id = 0; id < stringCount; id++) {
+        writer.putString(strings.str(id));
+    }
+
+    writeStates(writer, dataset.houseData);
+    writeStates(writer, dataset.occupationData);
+    std::vector<StringId> titles;
+    for (std::string_view title : dataset.occupationNames) {
+        titles.push_back(*strings.find(title));
+    }
+    writer.putArray(titles);
+
+    const HouseTable& houseTable = dataset.houseTable;
+    writer.putArray(houseTable.MeanValue);
+    writer.putArray(houseTable.State);
+    writer.putArray(houseTable.City);
+    writer.putArray(houseTable.CountyName);
+    writeDictionary(writer, houseTable.states);
+
+    const OccupationTable& occupationTable = dataset.occupationTable;
+    writer.putArray(occupationTable.TOT_EMP);
+    writer.putArray(occupationTable.A_MEAN);
+    writer.putArray(occupationTable.AREA);
+    writer.putArray(occupationTable.PRIM_STATE);
+    writer.putArray(occupationTable.OCC_TITLE);
+    writeDictionary(writer, occupationTable.states);
+
+    SnapshotCodec::write(writer, dataset.salaryIndex);
+    writer.putArray(dataset.homeStats.byState);
+    writer.putArray(dataset.homeStats.byCounty);
+    writer.putArray(dataset.homeStats.byCity);
+}
+
+bool validPlaces(const std::vector<PlaceStats>& places, std::size_t stateCount, std::uint64_t stringCount) {
+    for (const PlaceStats& place : places) {
+        if (place.state >= stateCount || place.name >= stringCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readPayload(SnapshotReader& reader, Dataset& dataset) {
+    // The stored strings are only interned once the whole payload has been read and every index in
+    // it checked, so a snapshot that is rejected leaves the string pool as it was
+    std::uint64_t stringCount = 0;
+    if (!reader.get(stringCount)) {
+        return false;
+    }
+    std::vector<std::string_view> values;
+    // Every string carries at least its length, which bounds a corrupt count
+    values.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(stringCount, reader.remaining() / 8)));
+    for (std::uint64_t i = 0; i < stringCount; i++) {
+        std::string_view value;
+        if (!reader.getString(value)) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    auto validId = [&](StringId id) { return id < stringCount; };
+    auto validColumn = [&](const std::vector<StringId>& column) {
+        return std::all_of(column.begin(), column.end(), validId);
+    };
+    auto validDense = [](const std::vector<std::uint32_t>& column, std::size_t limit) {
+        return std::all_of(column.begin(), column.end(), [limit](std::uint32_t id) { return id < limit; });
+    };
+
+    if (!readStates(reader, dataset.houseData) || !readStates(reader, dataset.occupationData)) {
+        return false;
+    }
+    for (const auto& entry : dataset.houseData) {
+        for (const HouseInfo& house : entry.second) {
+            if (!validId(house.RegionID) || !validId(house.State) || !validId(house.City) ||
+                !validId(house.CountyName)) {
+                return false;
+            }
+        }
+    }
+    for (const auto& entry : dataset.occupationData) {
+        for (const Occupation& occupation : entry.second) {
+            if (!validId(occupation.AREA) || !validId(occupation.PRIM_STATE) || !validId(occupation.OCC_TITLE)) {
+                return false;
+            }
+        }
+    }
+    std::vector<StringId> titles;
+    if (!reader.getArray(titles) || !validColumn(titles)) {
+        return false;
+    }
+
+    HouseTable& houseTable = dataset.houseTable;
+    if (!reader.getArray(houseTable.MeanValue) || !reader.getArray(houseTable.State) ||
+        !reader.getArray(houseTable.City) || !reader.getArray(houseTable.CountyName) ||
+        !readDictionary(reader, houseTable.states)) {
+        return false;
+    }
+    const std::size_t houseRows = houseTable.rows();
+    if (houseTable.State.size() != houseRows || houseTable.City.size() != houseRows ||
+        houseTable.CountyName.size() != houseRows || !validDense(houseTable.State, houseTable.states.size()) ||
+        !validColumn(houseTable.City) || !validColumn(houseTable.CountyName)) {
+        return false;
+    }
+    OccupationTable& occupationTable = dataset.occupationTable;
+    if (!reader.getArray(occupationTable.TOT_EMP) || !reader.getArray(occupationTable.A_MEAN) ||
+        !reader.getArray(occupationTable.AREA) || !reader.getArray(occupationTable.PRIM_STATE) ||
+        !reader.getArray(occupationTable.OCC_TITLE) || !readDictionary(reader, occupationTable.states)) {
+        return false;
+    }
+    const std::size_t occupationRows = occupationTable.rows();
+    if (occupationTable.TOT_EMP.size() != occupationRows || occupationTable.AREA.size() != occupationRows ||
+        occupationTable.PRIM_STATE.size() != occupationRows || occupationTable.OCC_TITLE.size() != occupationRows ||
+        !validDense(occupationTable.PRIM_STATE, occupationTable.states.size()) ||
+        !validColumn(occupationTable.AREA) || !validColumn(occupationTable.OCC_TITLE)) {
+        return false;
+    }
+
+    HomeValueStats& homeStats = dataset.homeStats;
+    std::vector<StringId> salaryTitles;
+    if (!SnapshotCodec::read(reader, dataset.salaryIndex, salaryTitles) || !reader.getArray(homeStats.byState) ||
+        !reader.getArray(homeStats.byCounty) || !reader.getArray(homeStats.byCity) || !reader.atEnd()) {
+        return false;
+    }
+    if (dataset.salaryIndex.states() != occupationTable.states.size() || !validColumn(salaryTitles) ||
+        homeStats.byState.size() != houseTable.states.size() ||
+        !validPlaces(homeStats.byCounty, houseTable.states.size(), stringCount) ||
+        !validPlaces(homeStats.byCity, houseTable.states.size(), stringCount)) {
+        return false;
+    }
+
+    // Strings are interned again; if the pool already held others their ids shift, and every
+    // stored id goes through remap. On a fresh start the mapping is the identity and is skipped.
+    StringPool& strings = stringPool();
+    std::vector<StringId> ids;
+    strings.internAll(values, ids);
+    bool identity = true;
+    for (std::size_t i = 0; i < ids.size() && identity; i++) {
+        identity = ids[i] == i;
+    }
+    auto remap = [&](StringId id) { return ids[id]; };
+    auto remapColumn = [&](std::vector<StringId>& column) {
+        for (StringId& id : column) {
+            id = remap(id);
+        }
+    };
+    if (!identity) {
+        for (auto& entry : dataset.houseData) {
+            for (HouseInfo& house : entry.second) {
+                house.RegionID = remap(house.RegionID);
+                house.State = remap(house.State);
+                house.City = remap(house.City);
+                house.CountyName = remap(house.CountyName);
+            }
+        }
+        for (auto& entry : dataset.occupationData) {
+            for (Occupation& occupation : entry.second) {
+                occupation.AREA = remap(occupation.AREA);
+                occupation.PRIM_STATE = remap(occupation.PRIM_STATE);
+                occupation.OCC_TITLE = remap(occupation.OCC_TITLE);
+            }
+        }
+        remapColumn(houseTable.City);
+        remapColumn(houseTable.CountyName);
+        remapColumn(occupationTable.AREA);
+        remapColumn(occupationTable.OCC_TITLE);
+        remapColumn(titles);
+        remapColumn(salaryTitles);
+        for (PlaceStats& county : homeStats.byCounty) {
+            county.name = remap(county.name);
+        }
+        for (PlaceStats& city : homeStats.byCity) {
+            city.name = remap(city.name);
+        }
+    }
+    if (!SnapshotCodec::setTitles(dataset.salaryIndex, salaryTitles)) {
+        return false;
+    }
+    for (StringId title : titles) {
+        dataset.occupationNames.insert(strings.str(title));
+    }
+    dataset.titleIndex = buildTitleIndex(dataset.occupationNames);
+    return true;
+}
+
+}
+
+// Four independent lanes take 32 bytes per round so the multiplies overlap instead of
+// waiting on one another, then fold into a single value at the end
+std::uint64_t hashBytes(const char* data, std::size_t size) {
+    const std::uint64_t multiplier = 0xff51afd7ed558ccdULL;
+    std::uint64_t lanes[4] = {0x9e3779b97f4a7c15ULL ^ size, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL,
+                              0x27d4eb2f165667c5ULL};
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; lane++) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * multiplier;
+            lanes[lane] ^= lanes[lane] >> 32;
+        }
+    }
+    std::uint64_t hash = lanes[0];
+    for (int lane = 1; lane < 4; lane++) {
+        hash = (hash ^ lanes[lane]) * multiplier;
+        hash ^= hash >> 32;
+    }
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 32;
+    }
+    std::uint64_t tail = 0;
+    if (i < size) {
+        std::memcpy(&tail, data + i, size - i);
+    }
+    hash = (hash ^ tail) * multiplier;
+    return hash ^ (hash >> 29);
+}
+
+bool statFile(const std::string& path, SourceFingerprint& fingerprint) {
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+    auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return false;
+    }
+    fingerprint.size = static_cast<std::uint64_t>(size);
+    fingerprint.modified = static_cast<std::int64_t>(modified.time_since_epoch().count());
+    return true;
+}
+
+bool fingerprintFile(const std::string& path, SourceFingerprint& fingerprint) {
+    if (!statFile(path, fingerprint)) {
+        return false;
+    }
+    MappedFile file;
+    if (!file.open(path) || file.size() != fingerprint.size) {
+        return false;
+    }
+    fingerprint.hash = hashBytes(file.begin(), file.size());
+    return true;
+}
+
+bool writeSnapshot(const Dataset& dataset, const std::string& path, const std::string& housePath,
+                   const std::string& occupationPath) {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.layout = snapshotLayout;
+    if (!fingerprintFile(housePath, header.house)) {
+        return false;
+    }
+    // A missing salary file loads as empty, and is fingerprinted as all zeros to match
+    fingerprintFile(occupationPath, header.occupation);
+
+    // The temporary file is opened before anything is serialized, so a read-only directory costs
+    // nothing but the failed open
+    const std::string temporary = path + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    SnapshotWriter writer;
+    writePayload(writer, dataset);
+    header.payloadSize = writer.bytes().size();
+    header.payloadChecksum = hashBytes(writer.bytes().data(), writer.bytes().size());
+
+    // A temporary file left by a failed write or rename is removed, so a full disk does not leave
+    // half a snapshot behind on every run
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(writer.bytes().data(), static_cast<std::streamsize>(writer.bytes().size()));
+    out.close();
+    std::error_code error;
+    if (out) {
+        std::filesystem::rename(temporary, path, error);
+    }
+    if (!out || error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool readSnapshot(Dataset& dataset, const std::string& path, const std::string& housePath,
+                  const std::string& occupationPath) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(SnapshotHeader)) {
+        return false;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, file.begin(), sizeof(header));
+    if (std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0 || header.version != snapshotVersion ||
+        header.layout != snapshotLayout || header.payloadSize != file.size() - sizeof(header)) {
+        return false;
+    }
+
+    // Size and modification time are checked first, so a CSV that has visibly changed is not read
+    // at all; only when both match is the content hashed, to catch an edit that kept them
+    SourceFingerprint house, occupation;
+    statFile(occupationPath, occupation);
+    if (!statFile(housePath, house) || house.size != header.house.size || house.modified != header.house.modified ||
+        occupation.size != header.occupation.size || occupation.modified != header.occupation.modified) {
+        return false;
+    }
+    if (!fingerprintFile(housePath, house) || !(house == header.house)) {
+        return false;
+    }
+    fingerprintFile(occupationPath, occupation);
+    if (!(occupation == header.occupation)) {
+        return false;
+    }
+
+    const char* payload = file.begin() + sizeof(header);
+    if (hashBytes(payload, header.payloadSize) != header.payloadChecksum) {
+        return false;
+    }
+    SnapshotReader reader(payload, payload + header.payloadSize);
+    return readPayload(reader, dataset);
+}
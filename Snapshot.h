@@ -0,0 +1,50 @@
+#ifndef PROJECT3_SNAPSHOT_H
+#define PROJECT3_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Dataset.h"
+
+// Bumped whenever the layout of anything written to a snapshot changes
+constexpr std::uint32_t snapshotVersion = 2;
+
+// Identity of a source CSV when a snapshot was written: size, modification time and a content hash
+struct SourceFingerprint {
+    std::uint64_t size = 0;
+    std::int64_t modified = 0;
+    std::uint64_t hash = 0;
+
+    bool operator==(const SourceFingerprint& other) const {
+        return size == other.size && modified == other.modified && hash == other.hash;
+    }
+};
+
+// Function to 64-bit hash a byte range a word at a time; used for file contents and snapshot checksums
+std::uint64_t hashBytes(const char* data, std::size_t size);
+
+// Function to fill in a file's size and modification time without reading it, returns false if it does not exist
+bool statFile(const std::string& path, SourceFingerprint& fingerprint);
+
+// Function to fingerprint a file, size and modification time plus a hash of its contents,
+// returns false if it cannot be read
+bool fingerprintFile(const std::string& path, SourceFingerprint& fingerprint);
+
+// Function to write a loaded dataset to path as a binary snapshot: the interned strings, the
+// per-state records, the columnar tables with their state dictionaries,
+// and the salary and home value aggregates, behind a versioned header holding fingerprints
+// of both CSVs and a checksum of everything after it. Written to a temporary file and renamed
+// into place, so a reader never sees half a snapshot. Returns false on any write error.
+bool writeSnapshot(const Dataset& dataset, const std::string& path, const std::string& housePath,
+                   const std::string& occupationPath);
+
+// Function to fill an empty dataset from the snapshot at path. The file is memory-mapped and
+// its arrays copied out directly, with no parsing or sorting; only the title index is rebuilt.
+// Returns false if the snapshot is missing, from another version or layout, fails its checksum,
+// or either CSV's fingerprint has changed; the dataset may then be partly filled and should be
+// discarded in favour of a fresh load from the CSVs.
+bool readSnapshot(Dataset& dataset, const std::string& path, const std::string& housePath,
+                  const std::string& occupationPath);
+
+#endif //PROJECT3_SNAPSHOT_H
@@ -0,0 +1,573 @@
+#ifndef PROJECT3_SORTING_H
+#define PROJECT3_SORTING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "RadixSort.h"
+#include "Records.h"
+#include "ThreadPool.h"
+
+// Ranges at or below this size are finished with insertion sort
+constexpr std::ptrdiff_t insertionSortCutoff = 16;
+
+// Ranges above this size take the pivot as a median of three medians (Tukey's ninther)
+constexpr std::ptrdiff_t nintherThreshold = 128;
+
+// Function that sorts a small range by shifting each element left into place
+template <typename RandomIt, typename Less>
+void insertionSort(RandomIt first, RandomIt last, Less less) {
+    if (first == last) {
+        return;
+    }
+    for (RandomIt i = first + 1; i < last; ++i) {
+        auto tmp = std::move(*i);
+        RandomIt j = i;
+        for (; j > first && less(tmp, *(j - 1)); --j) {
+            *j = std::move(*(j - 1));
+        }
+        *j = std::move(tmp);
+    }
+}
+
+// Function that restores the max-heap property below position root of a heap of size count
+template <typename RandomIt, typename Less>
+void siftDown(RandomIt first, std::ptrdiff_t root, std::ptrdiff_t count, Less less) {
+    auto tmp = std::move(first[root]);
+    while (true) {
+        std::ptrdiff_t child = 2 * root + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && less(first[child], first[child + 1])) {
+            child++;
+        }
+        if (!less(tmp, first[child])) {
+            break;
+        }
+        first[root] = std::move(first[child]);
+        root = child;
+    }
+    first[root] = std::move(tmp);
+}
+
+// Function that heapsorts a range; the introsort fallback once partitioning degenerates
+template <typename RandomIt, typename Less>
+void heapSort(RandomIt first, RandomIt last, Less less) {
+    std::ptrdiff_t count = last - first;
+    for (std::ptrdiff_t root = count / 2 - 1; root >= 0; root--) {
+        siftDown(first, root, count, less);
+    }
+    for (std::ptrdiff_t end = count - 1; end > 0; end--) {
+        std::swap(first[0], first[end]);
+        siftDown(first, 0, end, less);
+    }
+}
+
+// Function that orders *a, *b, *c so the median ends up in *b
+template <typename RandomIt, typename Less>
+void sortThree(RandomIt a, RandomIt b, RandomIt c, Less less) {
+    if (less(*b, *a)) {
+        std::swap(*a, *b);
+    }
+    if (less(*c, *b)) {
+        std::swap(*b, *c);
+        if (less(*b, *a)) {
+            std::swap(*a, *b);
+        }
+    }
+}
+
+// Function used in quicksort to divide the range (less than pivot on left, greater than on right)
+// The pivot is chosen by median-of-three or ninther and parked at first during the scan.
+// Equal keys stop both scans, so runs of duplicates still split down the middle.
+template <typename RandomIt, typename Less>
+RandomIt partitionAroundPivot(RandomIt first, RandomIt last, Less less) {
+    std::ptrdiff_t count = last - first;
+    RandomIt middle = first + count / 2;
+    if (count > nintherThreshold) {
+        std::ptrdiff_t step = count / 8;
+        sortThree(first, first + step, first + 2 * step, less);
+        sortThree(middle - step, middle, middle + step, less);
+        sortThree(last - 1 - 2 * step, last - 1 - step, last - 1, less);
+        sortThree(first + step, middle, last - 1 - step, less);
+    } else {
+        sortThree(first, middle, last - 1, less);
+    }
+    std::swap(*first, *middle);
+
+    RandomIt up = first, down = last;
+    while (true) {
+        while (++up < last && less(*up, *first)) {
+        }
+        while (less(*first, *--down)) {
+        }
+        if (up >= down) {
+            break;
+        }
+        std::swap(*up, *down);
+    }
+    std::swap(*first, *down);
+    return down;
+}
+
+// Function that returns the introsort depth budget for count elements, about 2 log2(count)
+inline std::ptrdiff_t introSortDepthBudget(std::ptrdiff_t count) {
+    std::ptrdiff_t depthBudget = 0;
+    for (std::ptrdiff_t n = count; n > 1; n >>= 1) {
+        depthBudget += 2;
+    }
+    return depthBudget;
+}
+
+// Function that runs introsort on a range with depthBudget partitioning levels left. The budget
+// is shared by the whole call tree: the smaller side is sorted with what remains after this
+// level's partition, so no path from the top partitions more than the budget allows.
+template <typename RandomIt, typename Less>
+void introSort(RandomIt first, RandomIt last, Less less, std::ptrdiff_t depthBudget) {
+    // Recursion is replaced by this loop for the larger side
+    while (last - first > insertionSortCutoff) {
+        if (depthBudget-- == 0) {
+            heapSort(first, last, less);
+            return;
+        }
+        RandomIt pivot = partitionAroundPivot(first, last, less);
+        if (pivot - first < last - pivot) {
+            introSort(first, pivot, less, depthBudget);
+            first = pivot + 1;
+        } else {
+            introSort(pivot + 1, last, less, depthBudget);
+            last = pivot;
+        }
+    }
+    insertionSort(first, last, less);
+}
+
+// Function to perform introsort: quicksort that recurses only into the smaller side and loops
+// on the larger one (so the stack stays O(log n)), hands a range to heapsort once the depth
+// budget of about 2 log2(n) is spent, and leaves small ranges to insertion sort
+template <typename RandomIt, typename Less>
+void quickSort(RandomIt first, RandomIt last, Less less) {
+    introSort(first, last, less, introSortDepthBudget(last - first));
+}
+
+template <typename RandomIt>
+void quickSort(RandomIt first, RandomIt last) {
+    quickSort(first, last, std::less<>());
+}
+
+// Vectors above this size are split across the pool by parallelQuickSort rather than sorted on one thread
+constexpr std::ptrdiff_t parallelSortThreshold = 1 << 17;
+
+// Inside parallelQuickSort, ranges at or below this size are finished sequentially by their task
+constexpr std::ptrdiff_t parallelSortGrain = 1 << 14;
+
+// Bookkeeping shared by the tasks of one parallelQuickSort call. Tasks never wait on each
+// other: each one counts itself out when done, even if it threw, and the last one fulfils the
+// promise, with the first exception any task threw so the waiting caller sees it.
+template <typename Less>
+struct ParallelSortJob {
+    ParallelSortJob(ThreadPool& pool, Less less) : pool(pool), less(less) {}
+
+    void fail(std::exception_ptr thrown) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+            error = thrown;
+        }
+    }
+
+    void finish() {
+        if (outstanding.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error) {
+            done.set_exception(error);
+        } else {
+            done.set_value();
+        }
+    }
+
+    ThreadPool& pool;
+    Less less;
+    std::atomic<std::size_t> outstanding{1};
+    std::promise<void> done;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+// One task of parallelQuickSort: partitions like quickSort, but hands the smaller side of each
+// split to a new task and keeps the larger one, until the range is small enough to finish here
+template <typename RandomIt, typename Less>
+void parallelQuickSortTask(std::shared_ptr<ParallelSortJob<Less>> job, RandomIt first, RandomIt last,
+                           std::ptrdiff_t depthBudget) {
+    try {
+        while (last - first > parallelSortGrain) {
+            if (depthBudget-- == 0) {
+                heapSort(first, last, job->less);
+                first = last;
+                break;
+            }
+            RandomIt pivot = partitionAroundPivot(first, last, job->less);
+            RandomIt spawnFirst = first, spawnLast = pivot;
+            if (pivot - first < last - pivot) {
+                first = pivot + 1;
+            } else {
+                spawnFirst = pivot + 1;
+                spawnLast = last;
+                last = pivot;
+            }
+            job->outstanding.fetch_add(1, std::memory_order_relaxed);
+            try {
+                job->pool.submit([job, spawnFirst, spawnLast, depthBudget]() {
+                    parallelQuickSortTask(job, spawnFirst, spawnLast, depthBudget);
+                });
+            } catch (...) {
+                // The split was never queued, so nothing else will count it out
+                job->outstanding.fetch_sub(1, std::memory_order_relaxed);
+                throw;
+            }
+        }
+        introSort(first, last, job->less, depthBudget);
+    } catch (...) {
+        job->fail(std::current_exception());
+    }
+    job->finish();
+}
+
+// Function to sort one large range across the pool: a quicksort whose partitions become tasks.
+// Ranges at or below parallelSortThreshold, or a single-thread pool, go straight to quickSort.
+// The caller blocks until the sort is done, so it must not be called from a task of the same pool.
+// If a comparison or a task allocation throws, the first exception is rethrown here once every
+// task has stopped, leaving the range in an unspecified order.
+template <typename RandomIt, typename Less>
+void parallelQuickSort(RandomIt first, RandomIt last, Less less, ThreadPool& pool) {
+    if (last - first <= parallelSortThreshold || pool.size() < 2) {
+        quickSort(first, last, less);
+        return;
+    }
+    std::ptrdiff_t depthBudget = introSortDepthBudget(last - first);
+    auto job = std::make_shared<ParallelSortJob<Less>>(pool, less);
+    std::future<void> finished = job->done.get_future();
+    pool.submit([job, first, last, depthBudget]() {
+        parallelQuickSortTask(job, first, last, depthBudget);
+    });
+    finished.get();
+}
+
+template <typename RandomIt>
+void parallelQuickSort(RandomIt first, RandomIt last, ThreadPool& pool) {
+    parallelQuickSort(first, last, std::less<>(), pool);
+}
+
+// Gap sequences for shell sort. Each policy fills gaps with its increments below n in
+// ascending order, always starting at 1.
+
+// Shell's original halving sequence n/2, n/4, ..., 1
+struct ShellGaps {
+    static constexpr const char* name = "Shell";
+    static void gaps(std::size_t n, std::vector<std::size_t>& gaps) {
+        gaps.clear();
+        for (std::size_t gap = n / 2; gap > 0; gap /= 2) {
+            gaps.insert(gaps.begin(), gap);
+        }
+        if (gaps.empty()) {
+            gaps.push_back(1);
+        }
+    }
+};
+
+// Knuth's 1, 4, 13, 40, ... (3k + 1), capped at n/3
+struct KnuthGaps {
+    static constexpr const char* name = "Knuth";
+    static void gaps(std::size_t n, std::vector<std::size_t>& gaps) {
+        gaps.assign(1, 1);
+        for (std::size_t gap = 4; gap <= n / 3; gap = 3 * gap + 1) {
+            gaps.push_back(gap);
+        }
+    }
+};
+
+// Sedgewick's 1986 sequence 1, 8, 23, 77, 281, ... (4^k + 3 * 2^(k-1) + 1)
+struct SedgewickGaps {
+    static constexpr const char* name = "Sedgewick";
+    static void gaps(std::size_t n, std::vector<std::size_t>& gaps) {
+        gaps.assign(1, 1);
+        for (std::size_t k = 1; ; k++) {
+            std::size_t gap = (std::size_t(1) << (2 * k)) + 3 * (std::size_t(1) << (k - 1)) + 1;
+            if (gap >= n) {
+                break;
+            }
+            gaps.push_back(gap);
+        }
+    }
+};
+
+// Ciura's empirically tuned 1, 4, 10, 23, 57, 132, 301, 701, 1750, extended by a factor of 2.25
+struct CiuraGaps {
+    static constexpr const char* name = "Ciura";
+    static void gaps(std::size_t n, std::vector<std::size_t>& gaps) {
+        static const std::size_t known[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+        gaps.assign(1, 1);
+        std::size_t gap = 1;
+        for (std::size_t i = 1; ; i++) {
+            gap = i < sizeof(known) / sizeof(known[0]) ? known[i] : static_cast<std::size_t>(gap * 2.25);
+            if (gap >= n) {
+                break;
+            }
+            gaps.push_back(gap);
+        }
+    }
+};
+
+// Tokuda's 1, 4, 9, 20, 46, 103, ... (ceil of h(k) = 2.25 h(k-1) + 1)
+struct TokudaGaps {
+    static constexpr const char* name = "Tokuda";
+    static void gaps(std::size_t n, std::vector<std::size_t>& gaps) {
+        gaps.assign(1, 1);
+        double h = 1.0;
+        while (true) {
+            h = 2.25 * h + 1.0;
+            std::size_t gap = static_cast<std::size_t>(std::ceil(h));
+            if (gap >= n) {
+                break;
+            }
+            gaps.push_back(gap);
+        }
+    }
+};
+
+// Counter handed to the sorts that does nothing, so uncounted sorts pay no cost
+struct NoSortCounts {
+    void compared() {}
+    void moved() {}
+};
+
+// Counter for the benchmark matrix: key comparisons and element moves
+struct SortCounts {
+    std::size_t comparisons = 0;
+    std::size_t moves = 0;
+    void compared() { comparisons++; }
+    void moved() { moves++; }
+};
+
+// Function to shell sort a range with the increments from GapPolicy, largest gap first
+template <typename GapPolicy, typename RandomIt, typename Less, typename Counts>
+void shellSort(RandomIt first, RandomIt last, Less less, Counts& counts) {
+    std::ptrdiff_t n = last - first;
+    if (n < 2) {
+        return;
+    }
+    std::vector<std::size_t> gaps;
+    GapPolicy::gaps(static_cast<std::size_t>(n), gaps);
+
+    for (auto gapIt = gaps.rbegin(); gapIt != gaps.rend(); ++gapIt) {
+        std::ptrdiff_t gap = static_cast<std::ptrdiff_t>(*gapIt);
+        for (std::ptrdiff_t i = gap; i < n; i++) {
+            auto tmp = std::move(first[i]);
+            counts.moved();
+            std::ptrdiff_t j = i;
+            for (; j >= gap; j -= gap) {
+                counts.compared();
+                if (!less(tmp, first[j - gap])) {
+                    break;
+                }
+                first[j] = std::move(first[j - gap]);
+                counts.moved();
+            }
+            first[j] = std::move(tmp);
+            counts.moved();
+        }
+    }
+}
+
+template <typename GapPolicy, typename RandomIt, typename Less>
+void shellSort(RandomIt first, RandomIt last, Less less) {
+    NoSortCounts counts;
+    shellSort<GapPolicy>(first, last, less, counts);
+}
+
+// Sort-by-index mode: the sorts run over (key, index) pairs projected from the records instead of
+// the records themselves, so each move copies 16 bytes whatever the record type, the record
+// vectors are left untouched, and the result is a permutation to read them through.
+// Keys are stored as radixKey values, so a comparison is one integer compare that already
+// places missing values last.
+using Permutation = std::vector<std::uint32_t>;
+
+struct KeyedIndex {
+    std::uint64_t key;
+    std::uint32_t index;
+};
+
+// Orders by key, then by position, so equal keys come out in input order
+inline bool keyedIndexLess(const KeyedIndex& a, const KeyedIndex& b) {
+    return a.key < b.key || (a.key == b.key && a.index < b.index);
+}
+
+template <typename T, typename Projection>
+std::vector<KeyedIndex> keyedIndices(const std::pmr::vector<T>& records, Projection key) {
+    std::vector<KeyedIndex> keyed;
+    keyed.reserve(records.size());
+    for (std::size_t i = 0; i < records.size(); i++) {
+        keyed.push_back({radixKey(key(records[i])), static_cast<std::uint32_t>(i)});
+    }
+    return keyed;
+}
+
+inline Permutation toPermutation(const std::vector<KeyedIndex>& keyed) {
+    Permutation order;
+    order.reserve(keyed.size());
+    for (const KeyedIndex& entry : keyed) {
+        order.push_back(entry.index);
+    }
+    return order;
+}
+
+// Function to quicksort the positions of records by key(record), leaving records as they are
+template <typename T, typename Projection>
+Permutation quickSortPermutation(const std::pmr::vector<T>& records, Projection key) {
+    std::vector<KeyedIndex> keyed = keyedIndices(records, key);
+    quickSort(keyed.begin(), keyed.end(), keyedIndexLess);
+    return toPermutation(keyed);
+}
+
+template <typename T>
+Permutation quickSortPermutation(const std::pmr::vector<T>& records) {
+    return quickSortPermutation(records, [](const T& record) { return sortKey(record); });
+}
+
+// Function to shell sort the positions of records by key(record), leaving records as they are
+template <typename GapPolicy = CiuraGaps, typename T, typename Projection>
+Permutation shellSortPermutation(const std::pmr::vector<T>& records, Projection key) {
+    std::vector<KeyedIndex> keyed = keyedIndices(records, key);
+    shellSort<GapPolicy>(keyed.begin(), keyed.end(), keyedIndexLess);
+    return toPermutation(keyed);
+}
+
+template <typename GapPolicy = CiuraGaps, typename T>
+Permutation shellSortPermutation(const std::pmr::vector<T>& records) {
+    return shellSortPermutation<GapPolicy>(records, [](const T& record) { return sortKey(record); });
+}
+
+// Function that copies records out in permutation order, for callers that need them laid out sorted.
+// The copy uses the default resource rather than the source's allocator, since that may be a
+// Dataset arena shared with concurrent readers.
+template <typename T>
+std::pmr::vector<T> materialize(const std::pmr::vector<T>& records, const Permutation& order) {
+    std::pmr::vector<T> sorted;
+    sorted.reserve(order.size());
+    for (std::uint32_t index : order) {
+        sorted.push_back(records[index]);
+    }
+    return sorted;
+}
+
+// Function that runs sortOne on every per-state vector as its own task on the pool.
+// States are queued largest first, so the longest sorts start right away and the small
+// states fill in behind them instead of one big state finishing alone at the end.
+template <typename T, typename SortFn>
+void sortStatesParallel(StateMap<T>& data, ThreadPool& pool, SortFn sortOne) {
+    std::vector<std::pmr::vector<T>*> states;
+    states.reserve(data.size());
+    for (auto& entry : data) {
+        states.push_back(&entry.second);
+    }
+    std::stable_sort(states.begin(), states.end(), [](const std::pmr::vector<T>* a, const std::pmr::vector<T>* b) {
+        return a->size() > b->size();
+    });
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(states.size());
+    for (std::pmr::vector<T>* dataSet : states) {
+        pending.push_back(pool.submit([dataSet, &sortOne]() {
+            sortOne(*dataSet);
+        }));
+    }
+    for (std::future<void>& task : pending) {
+        task.get();
+    }
+}
+
+// Define a template function for shell sorting
+// The gap sequence is picked at compile time, Ciura by default
+template <typename GapPolicy = CiuraGaps, typename T>
+void shellSortData(StateMap<T>& data) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (auto& entry : data) {
+        std::pmr::vector<T>& dataSet = entry.second;
+        shellSort<GapPolicy>(dataSet.begin(), dataSet.end(), std::less<>());
+    }
+
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    std::cout << "Shell Sort Time in Milliseconds: " << duration.count() / 1000.0 << std::endl;
+}
+
+// Define a template function for quick sorting
+template <typename T>
+void quickSortTop(StateMap<T>& data){
+    auto start = std::chrono::high_resolution_clock ::now();
+
+    for (auto& entry : data){
+        std::pmr::vector<T>& dataSet = entry.second;
+        quickSort(dataSet.begin(), dataSet.end());
+    }
+
+    auto stop = std::chrono::high_resolution_clock ::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop-start);
+    std::cout << "Quick Sort Time in Milliseconds: " <<  duration.count()/1000.0 << std::endl;
+}
+
+// Parallel versions of the two drivers: same per-state sorts, spread across the pool's workers
+template <typename GapPolicy = CiuraGaps, typename T>
+void shellSortData(StateMap<T>& data, ThreadPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    sortStatesParallel(data, pool, [](std::pmr::vector<T>& dataSet) {
+        shellSort<GapPolicy>(dataSet.begin(), dataSet.end(), std::less<>());
+    });
+
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    std::cout << "Parallel Shell Sort Time in Milliseconds (" << pool.size() << " threads): "
+              << duration.count() / 1000.0 << std::endl;
+}
+
+template <typename T>
+void quickSortTop(StateMap<T>& data, ThreadPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // States too big for one core are split across the whole pool one after another,
+    // then the rest are sorted a state per task
+    for (auto& entry : data) {
+        if (static_cast<std::ptrdiff_t>(entry.second.size()) > parallelSortThreshold) {
+            parallelQuickSort(entry.second.begin(), entry.second.end(), pool);
+        }
+    }
+    sortStatesParallel(data, pool, [](std::pmr::vector<T>& dataSet) {
+        if (static_cast<std::ptrdiff_t>(dataSet.size()) <= parallelSortThreshold) {
+            quickSort(dataSet.begin(), dataSet.end());
+        }
+    });
+
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+    std::cout << "Parallel Quick Sort Time in Milliseconds (" << pool.size() << " threads): "
+              << duration.count() / 1000.0 << std::endl;
+}
+
+#endif //PROJECT3_SORTING_H
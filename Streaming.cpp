@@ -0,0 +1,208 @@
+#include "Streaming.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <future>
+
+#include "CsvLoader.h"
+#include "NumberParse.h"
+
+namespace {
+
+// Numbers the names of a dictionary alphabetically into target, returning the new id of each old id
+std::vector<std::uint32_t> renumberAlphabetically(const StringDictionary& names, StringDictionary& target) {
+    std::vector<std::uint32_t> order(names.size());
+    for (std::uint32_t id = 0; id < order.size(); id++) {
+        order[id] = id;
+    }
+    std::sort(order.begin(), order.end(), [&names](std::uint32_t a, std::uint32_t b) {
+        return names.str(a) < names.str(b);
+    });
+    std::vector<std::uint32_t> renumbered(names.size());
+    for (std::uint32_t id : order) {
+        renumbered[id] = target.intern(names.str(id));
+    }
+    return renumbered;
+}
+
+// Start of the last line break in [begin, end) that ends a row, or nullptr if there is none.
+// begin must start a row; a line break inside a quoted field belongs to the field. inQuotes
+// walks back from the state at end, flipping at each quote passed.
+char* lastRowBreak(char* begin, char* end) {
+    bool inQuotes = quoteOpenAt(begin, end, false);
+    for (char* at = end; at != begin; --at) {
+        if (at[-1] == '"') {
+            inQuotes = !inQuotes;
+        } else if (at[-1] == '\n' && !inQuotes) {
+            return at - 1;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+void StreamingAggregator::addOccupation(std::string_view state, std::string_view title, double totEmp,
+                                        double aMean) {
+    std::uint32_t stateId = occupationStates.intern(state);
+    StringId titleId = titles.intern(title);
+    if (titleId == salaries.size()) {
+        salaries.emplace_back();
+    }
+    std::vector<SalaryAggregate>& byState = salaries[titleId];
+    if (byState.size() <= stateId) {
+        byState.resize(stateId + 1);
+    }
+    byState[stateId].add(aMean, totEmp);
+}
+
+void StreamingAggregator::addHouse(std::string_view state, std::string_view county, std::string_view city,
+                                   double meanValue) {
+    std::uint32_t stateId = houseStates.intern(state);
+    if (stateId == homeValues.size()) {
+        homeValues.emplace_back();
+    }
+    homeValues[stateId].add(meanValue);
+    // As in buildHomeValueStats, a place only exists once it has a row with a value
+    if (!isMissing(meanValue)) {
+        counties.add(stateId, county, houseRows, meanValue);
+        cities.add(stateId, city, houseRows, meanValue);
+    }
+    houseRows++;
+}
+
+void StreamingAggregator::PlaceGroup::add(std::uint32_t state, std::string_view name, std::uint64_t row,
+                                          double value) {
+    StringId nameId = names.intern(name);
+    std::uint64_t key = (static_cast<std::uint64_t>(state) << 32) | nameId;
+    auto slot = slots.emplace(key, static_cast<std::uint32_t>(places.size()));
+    if (slot.second) {
+        places.push_back({state, nameId, row, RunningStats()});
+    }
+    places[slot.first->second].stats.add(value);
+}
+
+std::vector<PlaceStats> StreamingAggregator::PlaceGroup::finish(const std::vector<std::uint32_t>& stateIds) const {
+    // A full load walks the states in order and each state's rows in file order
+    std::vector<std::uint32_t> order(places.size());
+    for (std::uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        std::uint32_t stateA = stateIds[places[a].state], stateB = stateIds[places[b].state];
+        return stateA != stateB ? stateA < stateB : places[a].firstRow < places[b].firstRow;
+    });
+    std::vector<PlaceStats> result;
+    result.reserve(places.size());
+    for (std::uint32_t i : order) {
+        result.push_back({stateIds[places[i].state], stringPool().intern(names.str(places[i].name)),
+                          places[i].stats.stats()});
+    }
+    return result;
+}
+
+void StreamingAggregator::finish(Dataset& dataset) {
+    std::vector<std::uint32_t> occupationStateIds =
+            renumberAlphabetically(occupationStates, dataset.occupationTable.states);
+    SalaryIndex& index = dataset.salaryIndex;
+    index.stateCount = occupationStates.size();
+    index.aggregates.assign(salaries.size() * index.stateCount, SalaryAggregate());
+    for (StringId title = 0; title < salaries.size(); title++) {
+        StringId pooled = stringPool().intern(titles.str(title));
+        index.titleSlots.emplace(pooled, title);
+        dataset.occupationNames.insert(stringPool().str(pooled));
+        for (std::uint32_t state = 0; state < salaries[title].size(); state++) {
+            index.aggregates[title * index.stateCount + occupationStateIds[state]] = salaries[title][state];
+        }
+    }
+
+    std::vector<std::uint32_t> houseStateIds = renumberAlphabetically(houseStates, dataset.houseTable.states);
+    HomeValueStats& homeStats = dataset.homeStats;
+    homeStats.byState.resize(homeValues.size());
+    for (std::uint32_t state = 0; state < homeValues.size(); state++) {
+        homeStats.byState[houseStateIds[state]] = homeValues[state].stats();
+    }
+    homeStats.byCounty = counties.finish(houseStateIds);
+    homeStats.byCity = cities.finish(houseStateIds);
+
+    dataset.titleIndex = buildTitleIndex(dataset.occupationNames);
+}
+
+StreamStatus streamCsvRows(const std::string& path, std::size_t blockBytes,
+                           const std::function<void(const std::vector<std::string_view>&)>& onRow) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return StreamStatus::CannotOpen;
+    }
+    std::vector<char> buffer(std::max<std::size_t>(blockBytes, 1));
+    std::vector<std::string_view> fields;
+    fields.reserve(8);
+    // Bytes of an unfinished row carried over to the front of the buffer
+    std::size_t carried = 0;
+    bool header = true;
+    while (true) {
+        if (carried == buffer.size()) {
+            if (carried >= maxStreamRowBytes) {
+                return StreamStatus::RowTooLong;
+            }
+            buffer.resize(std::min(buffer.size() * 2, maxStreamRowBytes));
+        }
+        std::size_t wanted = buffer.size() - carried;
+        file.read(buffer.data() + carried, static_cast<std::streamsize>(wanted));
+        std::size_t got = static_cast<std::size_t>(file.gcount());
+        bool last = got < wanted;
+
+        char* begin = buffer.data();
+        char* end = begin + carried + got;
+        char* cut = end;
+        if (!last) {
+            char* newline = lastRowBreak(begin, end);
+            if (!newline) {
+                carried += got;
+                continue;
+            }
+            cut = newline + 1;
+        }
+        char* start = begin;
+        if (header) {
+            char* newline = static_cast<char*>(std::memchr(begin, '\n', static_cast<std::size_t>(cut - begin)));
+            start = newline ? newline + 1 : cut;
+            header = false;
+        }
+        CsvReader reader(start, cut);
+        while (reader.nextRow(fields)) {
+            onRow(fields);
+        }
+        if (last) {
+            return StreamStatus::Finished;
+        }
+        carried = static_cast<std::size_t>(end - cut);
+        std::memmove(begin, cut, carried);
+    }
+}
+
+std::shared_ptr<const Dataset> streamDataset(const std::string& housePath, const std::string& occupationPath,
+                                             ThreadPool& pool, std::size_t blockBytes) {
+    StreamingAggregator aggregator;
+    std::future<StreamStatus> houses = pool.submit([&]() {
+        return streamCsvRows(housePath, blockBytes, [&](const std::vector<std::string_view>& fields) {
+            if (fields.size() >= 5) {
+                aggregator.addHouse(fields[1], fields[3], fields[2], parseNumber(fields[4]).value_or(missingValue));
+            }
+        });
+    });
+    // As with the full load, a missing salary file just leaves the occupation side empty
+    StreamStatus occupations = streamCsvRows(occupationPath, blockBytes, [&](const std::vector<std::string_view>& fields) {
+        if (fields.size() >= 5) {
+            aggregator.addOccupation(fields[1], fields[2], parseNumber(fields[3]).value_or(missingValue),
+                                     parseNumber(fields[4]).value_or(missingValue));
+        }
+    });
+    if (houses.get() != StreamStatus::Finished || occupations == StreamStatus::RowTooLong) {
+        return nullptr;
+    }
+    auto dataset = std::make_shared<Dataset>();
+    aggregator.finish(*dataset);
+    return dataset;
+}
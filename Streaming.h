@@ -0,0 +1,89 @@
+#ifndef PROJECT3_STREAMING_H
+#define PROJECT3_STREAMING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Aggregates.h"
+#include "Dataset.h"
+#include "StringPool.h"
+#include "ThreadPool.h"
+
+// Block size the streaming loader reads each file in
+constexpr std::size_t streamBlockBytes = 4 * 1024 * 1024;
+
+// Largest the streaming loader's buffer grows to hold a row longer than a block; an unterminated
+// quote would otherwise pull the rest of the file into memory
+constexpr std::size_t maxStreamRowBytes = 16 * 1024 * 1024;
+
+// How a streamed file ended
+enum class StreamStatus { Finished, CannotOpen, RowTooLong };
+
+// Class folding rows into the aggregates the queries read, without keeping the rows. Its memory
+// grows with the number of distinct states, titles, counties and cities, never with the number
+// of rows. The salary and housing sides share nothing, so one thread can feed each.
+class StreamingAggregator {
+public:
+    void addOccupation(std::string_view state, std::string_view title, double totEmp, double aMean);
+    void addHouse(std::string_view state, std::string_view county, std::string_view city, double meanValue);
+
+    // Hands the totals to an empty dataset as its state dictionaries, salary index, home value statistics,
+    // titles and title index. States are numbered alphabetically and places listed by their first row
+    // within their state, as a full load numbers them, so both break ranking ties the same way.
+    void finish(Dataset& dataset);
+
+private:
+    // Totals of one county or city; state and name are ids into the aggregator's own dictionaries
+    struct PlaceTotals {
+        std::uint32_t state;
+        StringId name;
+        std::uint64_t firstRow;
+        RunningStats stats;
+    };
+
+    // Places of one kind keyed by (state, name), since the same name turns up in several states
+    struct PlaceGroup {
+        StringDictionary names;
+        std::unordered_map<std::uint64_t, std::uint32_t> slots;
+        std::vector<PlaceTotals> places;
+
+        void add(std::uint32_t state, std::string_view name, std::uint64_t row, double value);
+        std::vector<PlaceStats> finish(const std::vector<std::uint32_t>& stateIds) const;
+    };
+
+    StringDictionary occupationStates;
+    StringDictionary titles;
+    // Indexed by title id, then occupation state id; grown as new states turn up
+    std::vector<std::vector<SalaryAggregate>> salaries;
+
+    StringDictionary houseStates;
+    std::vector<RunningStats> homeValues;
+    PlaceGroup counties;
+    PlaceGroup cities;
+    std::uint64_t houseRows = 0;
+};
+
+// Function to read a CSV file one block at a time and pass every row after the header to onRow.
+// Blocks are cut after their last newline outside a quoted field, so quoted fields may span lines
+// and blocks; a row longer than a block grows the buffer to fit it, but never past
+// maxStreamRowBytes. The fields view the buffer and are only valid during the call. Stops with
+// RowTooLong, after handing over the rows before it, once a row does not fit.
+StreamStatus streamCsvRows(const std::string& path, std::size_t blockBytes,
+                   const std::function<void(const std::vector<std::string_view>&)>& onRow);
+
+// Function to build a dataset holding only the aggregates, streaming both files through a
+// StreamingAggregator side by side on the pool. Memory stays bounded by the two block buffers
+// and the distinct values however large the files are. The record maps and row columns stay
+// empty, so the queries and title search work on it but the sorts have nothing to sort.
+// Returns nullptr if the housing file cannot be opened or either file has a row longer than
+// maxStreamRowBytes; a missing salary file leaves no titles.
+std::shared_ptr<const Dataset> streamDataset(const std::string& housePath, const std::string& occupationPath,
+                                             ThreadPool& pool, std::size_t blockBytes = streamBlockBytes);
+
+#endif //PROJECT3_STREAMING_H
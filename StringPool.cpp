@@ -0,0 +1,85 @@
+#include "StringPool.h"
+
+#include <cstring>
+
+StringDictionary::StringDictionary() : characters(new std::pmr::monotonic_buffer_resource(64 * 1024)) {}
+
+StringId StringDictionary::intern(std::string_view value) {
+    auto found = ids.find(value);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    char* copy = static_cast<char*>(characters->allocate(value.size() + 1, 1));
+    std::memcpy(copy, value.data(), value.size());
+    copy[value.size()] = '\0';
+    characterBytes += value.size() + 1;
+
+    StringId id = static_cast<StringId>(values.size());
+    values.emplace_back(copy, value.size());
+    ids.emplace(values.back(), id);
+    return id;
+}
+
+std::optional<StringId> StringDictionary::find(std::string_view value) const {
+    auto found = ids.find(value);
+    if (found == ids.end()) {
+        return std::nullopt;
+    }
+    return found->second;
+}
+
+void StringDictionary::reserve(std::size_t count) {
+    ids.reserve(ids.size() + count);
+}
+
+std::size_t StringDictionary::memoryBytes() const {
+    std::size_t bytes = characterBytes + values.size() * sizeof(std::string_view);
+    // Hash node (key view, id, next pointer, cached hash) plus one bucket pointer per bucket
+    bytes += ids.size() * (sizeof(std::string_view) + sizeof(StringId) + 2 * sizeof(void*));
+    bytes += ids.bucket_count() * sizeof(void*);
+    return bytes;
+}
+
+StringId StringPool::intern(std::string_view value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dictionary.intern(value);
+}
+
+std::optional<StringId> StringPool::find(std::string_view value) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dictionary.find(value);
+}
+
+void StringPool::internAll(const std::vector<std::string_view>& values, std::vector<StringId>& ids) {
+    std::lock_guard<std::mutex> lock(mutex);
+    dictionary.reserve(values.size());
+    ids.reserve(ids.size() + values.size());
+    for (std::string_view value : values) {
+        ids.push_back(dictionary.intern(value));
+    }
+}
+
+std::size_t StringPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dictionary.size();
+}
+
+std::size_t StringPool::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dictionary.memoryBytes();
+}
+
+StringPool& stringPool() {
+    static StringPool pool;
+    return pool;
+}
+
+StringId StringPoolCache::intern(std::string_view value) {
+    auto found = cached.find(value);
+    if (found != cached.end()) {
+        return found->second;
+    }
+    StringId id = pool.intern(value);
+    cached.emplace(value, id);
+    return id;
+}
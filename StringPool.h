@@ -0,0 +1,84 @@
+#ifndef PROJECT3_STRINGPOOL_H
+#define PROJECT3_STRINGPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Compact id standing in for an interned string
+using StringId = std::uint32_t;
+
+// Class mapping each distinct string to a dense integer id, assigned in first-seen order.
+// The characters are copied into large arena blocks rather than one allocation per string,
+// and never move, so the views handed out stay valid for the dictionary's lifetime.
+class StringDictionary {
+public:
+    StringDictionary();
+
+    StringId intern(std::string_view value);
+    std::optional<StringId> find(std::string_view value) const;
+
+    // Makes room for count more strings so a bulk intern does not rehash along the way
+    void reserve(std::size_t count);
+
+    std::string_view str(StringId id) const { return values[id]; }
+    std::size_t size() const { return values.size(); }
+
+    // Approximate heap bytes held by the dictionary
+    std::size_t memoryBytes() const;
+
+private:
+    // Held by pointer so the dictionary can move without the characters moving
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> characters;
+    std::size_t characterBytes = 0;
+    std::deque<std::string_view> values;
+    std::unordered_map<std::string_view, StringId> ids;
+};
+
+// Class holding the process-wide interned strings used by the records.
+// intern and find may be called from any thread; str is lock free and must not
+// overlap with interning, which only happens while the data files are loading.
+class StringPool {
+public:
+    StringId intern(std::string_view value);
+    std::optional<StringId> find(std::string_view value) const;
+
+    // Interns every value under one lock, appending their ids to ids in the same order
+    void internAll(const std::vector<std::string_view>& values, std::vector<StringId>& ids);
+
+    std::string_view str(StringId id) const { return dictionary.str(id); }
+    std::size_t size() const;
+    std::size_t memoryBytes() const;
+
+private:
+    mutable std::mutex mutex;
+    StringDictionary dictionary;
+};
+
+// Function that returns the shared pool
+StringPool& stringPool();
+
+// Class caching pool lookups for one loading thread so repeated values skip the pool lock.
+// The cache keys view the caller's buffer, so it must not outlive that buffer. Its nodes
+// come from a private arena, since unique values such as RegionID would otherwise cost
+// one heap allocation each.
+class StringPoolCache {
+public:
+    explicit StringPoolCache(StringPool& pool) : pool(pool), arena(64 * 1024), cached(&arena) {}
+
+    StringId intern(std::string_view value);
+
+private:
+    StringPool& pool;
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::unordered_map<std::string_view, StringId> cached;
+};
+
+#endif //PROJECT3_STRINGPOOL_H
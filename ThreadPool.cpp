@@ -0,0 +1,104 @@
+#include "ThreadPool.h"
+
+namespace {
+
+// The pool and deque index of the worker running on this thread, if any
+thread_local const void* currentPool = nullptr;
+thread_local std::size_t currentIndex = 0;
+
+}
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    queues.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    // A worker's own tasks go on the back of its deque, where it takes them next; tasks from outside
+    // the pool go on the front, so the owner still runs them in submission order behind its own work
+    bool fromWorker = currentPool == this;
+    std::size_t index = fromWorker ? currentIndex
+                                   : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        if (fromWorker) {
+            queues[index]->tasks.push_back(std::move(task));
+        } else {
+            queues[index]->tasks.push_front(std::move(task));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        pending++;
+    }
+    wake.notify_one();
+}
+
+// Takes the task at the back of worker index's deque, or steals from the front of another's. The
+// owner works through its own splits newest first, depth first while they are hot in cache; thieves
+// take the other end, where a recursive split leaves its largest pieces
+bool ThreadPool::takeTask(std::size_t index, std::function<void()>& task) {
+    for (std::size_t offset = 0; offset < queues.size(); offset++) {
+        WorkQueue& queue = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (offset == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            steals.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            wake.wait(lock, [this]() { return stopping || pending > 0; });
+            if (pending == 0) {
+                return;
+            }
+            // Claim one queued task. pending only counts tasks already on a deque, so claims
+            // never outnumber them, but one pass over the deques can still miss the task left
+            // for this claim while other workers take theirs, hence the retry.
+            pending--;
+        }
+        std::function<void()> task;
+        while (!takeTask(index, task)) {
+            std::this_thread::yield();
+        }
+        task();
+    }
+}
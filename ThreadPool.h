@@ -0,0 +1,69 @@
+#ifndef PROJECT3_THREADPOOL_H
+#define PROJECT3_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Class that runs submitted tasks on a fixed set of worker threads.
+// Every worker owns a deque and takes its tasks from the back; once it runs dry it steals from the
+// front of the others'. Tasks submitted from outside the pool are spread across the deques and pushed
+// on the front, so each worker runs them oldest first. Tasks submitted from inside a task are pushed on
+// the back of the submitting worker's deque, so a worker finishes its own splits depth first while the
+// larger, older pieces are left for thieves.
+// Tasks must not block waiting on other tasks of the same pool
+class ThreadPool {
+public:
+    // A count of 0 uses one thread per hardware thread
+    explicit ThreadPool(std::size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    // Number of tasks a worker has taken from another worker's deque so far
+    std::size_t stealCount() const { return steals.load(std::memory_order_relaxed); }
+
+    // Queues task and returns a future for its result
+    template <typename F>
+    auto submit(F&& task) -> std::future<typename std::invoke_result<F>::type> {
+        using Result = typename std::invoke_result<F>::type;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        push([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(std::function<void()> task);
+    bool takeTask(std::size_t index, std::function<void()>& task);
+    void workerLoop(std::size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> nextQueue{0};
+    std::atomic<std::size_t> steals{0};
+
+    // Idle workers sleep here; pending counts queued tasks not yet taken
+    std::mutex idleMutex;
+    std::condition_variable wake;
+    std::size_t pending = 0;
+    bool stopping = false;
+};
+
+#endif //PROJECT3_THREADPOOL_H
@@ -0,0 +1,237 @@
+#include "TitleIndex.h"
+
+#include <algorithm>
+#include <map>
+
+#include "TopK.h"
+
+namespace {
+
+bool isWordChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+char toLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Keeps the ids present in both ascending lists
+void intersect(std::vector<std::uint32_t>& ids, const std::vector<std::uint32_t>& other) {
+    std::vector<std::uint32_t> both;
+    std::set_intersection(ids.begin(), ids.end(), other.begin(), other.end(), std::back_inserter(both));
+    ids.swap(both);
+}
+
+// Distinct trigrams of a lowercase word padded as "  word ", packed three bytes to an integer.
+// The padding gives short words trigrams of their own and weights the start of a word.
+void trigrams(const std::string& word, std::vector<std::uint32_t>& grams) {
+    grams.clear();
+    std::string padded = "  " + word + " ";
+    for (std::size_t i = 0; i + 3 <= padded.size(); i++) {
+        grams.push_back(static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i])) << 16 |
+                        static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8 |
+                        static_cast<unsigned char>(padded[i + 2]));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+}
+
+void tokenize(std::string_view text, std::vector<std::string>& words) {
+    words.clear();
+    std::string word;
+    for (char c : text) {
+        if (isWordChar(c)) {
+            word.push_back(toLower(c));
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(word);
+    }
+}
+
+std::pair<std::uint32_t, std::uint32_t> TitleIndex::wordsWithPrefix(std::string_view prefix) const {
+    if (trie.empty()) {
+        return {0, 0};
+    }
+    std::uint32_t node = 0;
+    for (char c : prefix) {
+        const auto& children = trie[node].children;
+        auto child = std::find_if(children.begin(), children.end(),
+                                  [c](const std::pair<char, std::uint32_t>& entry) { return entry.first == c; });
+        if (child == children.end()) {
+            return {0, 0};
+        }
+        node = child->second;
+    }
+    return {trie[node].firstWord, trie[node].lastWord};
+}
+
+std::vector<std::uint32_t> TitleIndex::match(std::string_view query) const {
+    std::vector<std::string> queryWords;
+    tokenize(query, queryWords);
+
+    std::vector<std::uint32_t> ids;
+    if (queryWords.empty()) {
+        return ids;
+    }
+
+    std::vector<char> seen(titles.size());
+    for (std::size_t i = 0; i < queryWords.size(); i++) {
+        // Titles holding any word that starts with this query word
+        std::pair<std::uint32_t, std::uint32_t> run = wordsWithPrefix(queryWords[i]);
+        std::fill(seen.begin(), seen.end(), 0);
+        for (std::uint32_t word = run.first; word < run.second; word++) {
+            for (std::uint32_t id : postings[word]) {
+                seen[id] = 1;
+            }
+        }
+        std::vector<std::uint32_t> wordIds;
+        for (std::uint32_t id = 0; id < seen.size(); id++) {
+            if (seen[id]) {
+                wordIds.push_back(id);
+            }
+        }
+        if (i == 0) {
+            ids.swap(wordIds);
+        } else {
+            intersect(ids, wordIds);
+        }
+        if (ids.empty()) {
+            break;
+        }
+    }
+    return ids;
+}
+
+std::vector<TitleMatch> TitleIndex::fuzzyMatch(std::string_view query, std::size_t limit,
+                                               double minSimilarity) const {
+    std::vector<std::string> queryWords;
+    tokenize(query, queryWords);
+    if (queryWords.empty() || titles.empty()) {
+        return {};
+    }
+
+    std::vector<double> titleScore(titles.size(), 0.0);
+    std::vector<double> bestInTitle(titles.size());
+    std::vector<std::uint32_t> shared(words.size(), 0);
+    std::vector<std::uint32_t> touched, grams;
+    for (const std::string& queryWord : queryWords) {
+        // Count the trigrams each vocabulary word shares with the query word
+        trigrams(queryWord, grams);
+        touched.clear();
+        for (std::uint32_t gram : grams) {
+            auto found = trigramWords.find(gram);
+            if (found == trigramWords.end()) {
+                continue;
+            }
+            for (std::uint32_t word : found->second) {
+                if (shared[word]++ == 0) {
+                    touched.push_back(word);
+                }
+            }
+        }
+
+        // Each title keeps the similarity of its closest word to this query word
+        std::fill(bestInTitle.begin(), bestInTitle.end(), 0.0);
+        for (std::uint32_t word : touched) {
+            double similarity = static_cast<double>(shared[word]) /
+                                static_cast<double>(grams.size() + trigramCounts[word] - shared[word]);
+            shared[word] = 0;
+            for (std::uint32_t id : postings[word]) {
+                bestInTitle[id] = std::max(bestInTitle[id], similarity);
+            }
+        }
+        for (std::size_t id = 0; id < titles.size(); id++) {
+            titleScore[id] += bestInTitle[id];
+        }
+    }
+
+    std::vector<std::uint32_t> ids(titles.size());
+    for (std::uint32_t id = 0; id < ids.size(); id++) {
+        ids[id] = id;
+    }
+    const double wordCount = static_cast<double>(queryWords.size());
+    auto ranked = topK(ids.begin(), ids.end(), limit, [&](std::uint32_t id) {
+        double similarity = titleScore[id] / wordCount;
+        return similarity >= minSimilarity ? similarity : missingValue;
+    });
+    std::vector<TitleMatch> matches;
+    matches.reserve(ranked.size());
+    for (const auto& entry : ranked) {
+        matches.push_back({entry.item, entry.score});
+    }
+    return matches;
+}
+
+std::size_t TitleIndex::memoryBytes() const {
+    std::size_t bytes = titles.capacity() * sizeof(std::string_view) + words.capacity() * sizeof(std::string) +
+                        postings.capacity() * sizeof(postings[0]) + trie.capacity() * sizeof(TrieNode);
+    for (std::size_t i = 0; i < words.size(); i++) {
+        bytes += words[i].capacity() + postings[i].capacity() * sizeof(std::uint32_t);
+    }
+    for (const TrieNode& node : trie) {
+        bytes += node.children.capacity() * sizeof(node.children[0]);
+    }
+    bytes += trigramCounts.capacity() * sizeof(std::uint32_t) + trigramWords.bucket_count() * sizeof(void*);
+    for (const auto& entry : trigramWords) {
+        bytes += sizeof(entry) + 2 * sizeof(void*) + entry.second.capacity() * sizeof(std::uint32_t);
+    }
+    return bytes;
+}
+
+TitleIndex buildTitleIndex(const std::set<std::string_view>& occupationNames) {
+    TitleIndex index;
+    index.titles.assign(occupationNames.begin(), occupationNames.end());
+
+    // Ordered so the vocabulary comes out sorted and each word's title ids ascending
+    std::map<std::string, std::vector<std::uint32_t>> vocabulary;
+    std::vector<std::string> titleWords;
+    for (std::uint32_t id = 0; id < index.titles.size(); id++) {
+        tokenize(index.titles[id], titleWords);
+        for (const std::string& word : titleWords) {
+            std::vector<std::uint32_t>& ids = vocabulary[word];
+            if (ids.empty() || ids.back() != id) {
+                ids.push_back(id);
+            }
+        }
+    }
+
+    index.trie.emplace_back();
+    for (auto& entry : vocabulary) {
+        std::uint32_t word = static_cast<std::uint32_t>(index.words.size());
+        index.words.push_back(entry.first);
+        index.postings.push_back(std::move(entry.second));
+
+        // Words arrive in sorted order, so each node's run only ever grows at the end
+        std::uint32_t node = 0;
+        index.trie[0].lastWord = word + 1;
+        for (char c : index.words.back()) {
+            auto& children = index.trie[node].children;
+            auto child = std::find_if(children.begin(), children.end(),
+                                      [c](const std::pair<char, std::uint32_t>& entry) { return entry.first == c; });
+            if (child == children.end()) {
+                std::uint32_t created = static_cast<std::uint32_t>(index.trie.size());
+                children.emplace_back(c, created);
+                index.trie.emplace_back();
+                index.trie.back().firstWord = word;
+                node = created;
+            } else {
+                node = child->second;
+            }
+            index.trie[node].lastWord = word + 1;
+        }
+
+        std::vector<std::uint32_t> grams;
+        trigrams(index.words.back(), grams);
+        index.trigramCounts.push_back(static_cast<std::uint32_t>(grams.size()));
+        for (std::uint32_t gram : grams) {
+            index.trigramWords[gram].push_back(word);
+        }
+    }
+    return index;
+}
@@ -0,0 +1,67 @@
+#ifndef PROJECT3_TITLEINDEX_H
+#define PROJECT3_TITLEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Function to split text into lowercase words at anything that is not a letter or digit
+void tokenize(std::string_view text, std::vector<std::string>& words);
+
+// A title found by fuzzyMatch and its similarity to the query, from 0 to 1
+struct TitleMatch {
+    std::uint32_t id;
+    double similarity;
+};
+
+// Class for searching the distinct occupation titles by word prefix, case-insensitively.
+// Every title is split into lowercase words; an inverted index maps each distinct word to
+// the titles containing it, and a trie over the sorted words maps any prefix to the run of
+// words that start with it. A second index maps each trigram of the padded words to the
+// words containing it, for typo-tolerant matching. Title ids are positions in the sorted title list.
+class TitleIndex {
+public:
+    // Ids of the titles in which every word of query starts some word, ascending.
+    // A query with no words (blank or only punctuation) matches nothing.
+    std::vector<std::uint32_t> match(std::string_view query) const;
+
+    // Up to limit titles ranked by trigram similarity to query, best first, none below minSimilarity.
+    // Each query word is scored against its closest word in the title (Jaccard similarity of
+    // their trigram sets) and a title's similarity is the average over the query words.
+    std::vector<TitleMatch> fuzzyMatch(std::string_view query, std::size_t limit = 10,
+                                       double minSimilarity = 0.3) const;
+
+    std::string_view title(std::uint32_t id) const { return titles[id]; }
+    std::size_t size() const { return titles.size(); }
+    std::size_t memoryBytes() const;
+
+private:
+    friend TitleIndex buildTitleIndex(const std::set<std::string_view>& occupationNames);
+
+    // Words below a node are a contiguous run [firstWord, lastWord) of the sorted vocabulary
+    struct TrieNode {
+        std::vector<std::pair<char, std::uint32_t>> children;
+        std::uint32_t firstWord = 0;
+        std::uint32_t lastWord = 0;
+    };
+
+    // The run of vocabulary words starting with prefix, empty if there are none
+    std::pair<std::uint32_t, std::uint32_t> wordsWithPrefix(std::string_view prefix) const;
+
+    std::vector<std::string_view> titles;
+    std::vector<std::string> words;
+    std::vector<std::vector<std::uint32_t>> postings;
+    std::vector<TrieNode> trie;
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> trigramWords;
+    std::vector<std::uint32_t> trigramCounts;
+};
+
+// Function to build the search index over the distinct titles; the views must outlive it
+TitleIndex buildTitleIndex(const std::set<std::string_view>& occupationNames);
+
+#endif //PROJECT3_TITLEINDEX_H
@@ -0,0 +1,98 @@
+#ifndef PROJECT3_TOPK_H
+#define PROJECT3_TOPK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "Records.h"
+
+// An item together with the score it was ranked by and its position in the input
+template <typename T>
+struct Ranked {
+    T item;
+    double score;
+    std::size_t position;
+};
+
+// Higher score first, ties to the item that came first in the input
+template <typename T>
+bool rankedBetter(const Ranked<T>& a, const Ranked<T>& b) {
+    return a.score > b.score || (a.score == b.score && a.position < b.position);
+}
+
+// Function to pick the k items of [first, last) with the highest score(item), best first.
+// A heap of the best k seen so far is kept with the worst of them on top, so each item costs
+// at most O(log k) and the input is never sorted as a whole. Items whose score is missing are
+// skipped; fewer than k results come back when fewer items have a score.
+template <typename InputIt, typename Score>
+std::vector<Ranked<typename std::iterator_traits<InputIt>::value_type>> topKHeap(InputIt first, InputIt last,
+                                                                                  std::size_t k, Score score) {
+    using Item = typename std::iterator_traits<InputIt>::value_type;
+    std::vector<Ranked<Item>> best;
+    if (k == 0) {
+        return best;
+    }
+    best.reserve(k);
+    auto worstOnTop = rankedBetter<Item>;
+    std::size_t position = 0;
+    for (; first != last; ++first, ++position) {
+        double value = score(*first);
+        if (isMissing(value)) {
+            continue;
+        }
+        Ranked<Item> candidate{*first, value, position};
+        if (best.size() < k) {
+            best.push_back(candidate);
+            std::push_heap(best.begin(), best.end(), worstOnTop);
+        } else if (rankedBetter(candidate, best.front())) {
+            std::pop_heap(best.begin(), best.end(), worstOnTop);
+            best.back() = candidate;
+            std::push_heap(best.begin(), best.end(), worstOnTop);
+        }
+    }
+    std::sort_heap(best.begin(), best.end(), worstOnTop);
+    return best;
+}
+
+// Same result as topKHeap, by scoring everything and partitioning with nth_element: O(n + k log k)
+// time but O(n) extra space, which pays off once k is a sizeable share of n
+template <typename InputIt, typename Score>
+std::vector<Ranked<typename std::iterator_traits<InputIt>::value_type>> topKSelect(InputIt first, InputIt last,
+                                                                                    std::size_t k, Score score) {
+    using Item = typename std::iterator_traits<InputIt>::value_type;
+    std::vector<Ranked<Item>> all;
+    std::size_t position = 0;
+    for (; first != last; ++first, ++position) {
+        double value = score(*first);
+        if (!isMissing(value)) {
+            all.push_back({*first, value, position});
+        }
+    }
+    k = std::min(k, all.size());
+    std::nth_element(all.begin(), all.begin() + k, all.end(), rankedBetter<Item>);
+    all.resize(k);
+    std::sort(all.begin(), all.end(), rankedBetter<Item>);
+    return all;
+}
+
+// Above this share of the input (k * topKSelectRatio >= n) topK switches from the heap to nth_element
+constexpr std::size_t topKSelectRatio = 8;
+
+// Function to pick the k best items, best first: topKHeap for small k, topKSelect once k is a
+// sizeable share of a range whose length is known up front
+template <typename InputIt, typename Score>
+std::vector<Ranked<typename std::iterator_traits<InputIt>::value_type>> topK(InputIt first, InputIt last,
+                                                                              std::size_t k, Score score) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+        if (k * topKSelectRatio >= static_cast<std::size_t>(std::distance(first, last))) {
+            return topKSelect(first, last, k, score);
+        }
+    }
+    return topKHeap(first, last, k, score);
+}
+
+#endif //PROJECT3_TOPK_H
@@ -10,82 +10,28 @@
 #include <chrono>
 #include <iomanip>
 #include <cmath>
+#include <string_view>
+#include <optional>
+
+#include "Batch.h"
+#include "Bench.h"
+#include "CommandLine.h"
+#include "Dataset.h"
+#include "Queries.h"
+#include "RadixSort.h"
+#include "Records.h"
+#include "Server.h"
+#include "Sorting.h"
+#include "Streaming.h"
+#include "StringPool.h"
+#include "ThreadPool.h"
 using namespace std;
 
 
-// Class representing an occupation with relevant information
-class Occupation {
-public:
-    std::string AREA;
-    std::string PRIM_STATE;
-    std::string OCC_TITLE;
-    double TOT_EMP;
-    double A_MEAN;
-
-    bool operator>(const Occupation& other) const{
-        return A_MEAN > other.A_MEAN;
-    }
-
-    bool operator<(const Occupation& other) const{
-        return A_MEAN < other.A_MEAN;
-    }
-
-    Occupation(const std::string& area, const std::string& prim_state, const std::string& occ_title, double tot_emp, double a_mean)
-            : AREA(area), PRIM_STATE(prim_state), OCC_TITLE(occ_title), TOT_EMP(tot_emp), A_MEAN(a_mean) {}
-};
-
-// Class representing information about a zip code, including home cost and associated occupations
-class HouseInfo {
-public:
-    std::string RegionID;
-    std::string State;
-    std::string City;
-    std::string CountyName;
-    double MeanValue;
-
-    HouseInfo(const std::string& regionID, const std::string& state, const std::string& city, const std::string& countyName, double meanValue)
-            : RegionID(regionID), State(state), City(city), CountyName(countyName), MeanValue(meanValue) {}
-
-    HouseInfo(double cost = 0.0) : MeanValue(cost) {}
-
-    bool operator>(const HouseInfo& other) const{
-        return MeanValue > other.MeanValue;
-    }
-
-    bool operator<(const HouseInfo& other) const{
-        return MeanValue < other.MeanValue;
-    }
-
-};
-
-// Function to check if a string contains only numeric characters
-bool isNumeric(const std::string& str) {
-    return !str.empty() && std::all_of(str.begin(), str.end(), ::isdigit);
-}
-
-// Function to convert a string to double, handling non-numeric cases
-double convertToDouble(const std::string& str) {
-    return isdigit(str[0]) ? std::stod(str) : 0.0;
-}
-
-// Function to search if selected occupation is a keyword
-std::set<std::string> searchOccupations(const std::map<std::string, std::vector<Occupation>> occupationData, const std::string& keyword) {
-    std::set<std::string> matchingTitles;
-
-    for(const auto& state:occupationData){
-        for(const auto & i : state.second){
-            if(!(i.OCC_TITLE.find(keyword))){
-                matchingTitles.insert(i.OCC_TITLE);
-            }
-        }
-    }
-    return matchingTitles;
-}
-
 // Function that returns number of data points in each dataset to distinguish sorts
 // 100092 = Occupation Data, 26261 = House Data
 template <typename T>
-void countRecords(std::map<std::string, std::vector<T>>& data){
+void countRecords(const StateMap<T>& data){
     size_t totalVectorsinSalary = 0;
     size_t totalEntriesinSalary = 0;
 
@@ -102,241 +48,66 @@ void countRecords(std::map<std::string, std::vector<T>>& data){
 }
 
 
-// Define a template function for shell sorting
-// Gap is n/2
+// Function that times shell sort, quicksort and radix sort on the same unsorted input, one state at a time
+// and then with the states spread across the pool
+// Each sort gets its own scratch copy, taken only for the comparison and released right after,
+// so the loaded data stays in load order and is never held twice between queries
 template <typename T>
-void shellSortData(std::map<std::string, std::vector<T>>& data) {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    for (auto& entry : data) {
-        std::vector<T>& dataSet = entry.second;
-        int n = dataSet.size();
+void compareSorts(const StateMap<T>& data, ThreadPool& pool){
+    // Return number of data points for the data
+    countRecords(data);
+    std::cout << std::endl;
 
-        for (int gap = n / 2; gap > 0; gap /= 2) {
-            for (int i = gap; i < n; i++) {
-                T tmp = dataSet[i];
-                int j;
-                for (j = i; j >= gap && dataSet[j - gap] > tmp; j -= gap) {
-                    dataSet[j] = dataSet[j - gap];
-                }
-                dataSet[j] = tmp;
-            }
-        }
+    {
+        // Search using shell sort
+        StateMap<T> scratch = data;
+        shellSortData(scratch);
     }
-
-    auto stop = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
-    std::cout << "Shell Sort Time in Milliseconds: " << duration.count() / 1000.0 << std::endl;
-}
-
-// Function used in quicksort to divide array (less than pivot on left, greater than on right)
-template <typename T>
-int partition(std::vector<T>& data, int low, int high)
-{
-    // Select the pivot element
-    T pivot = data[low];
-    int up = low, down = high;
-    while (up < down)
     {
-        for (int j = up; j < high; j++)
-        {
-            if (data[up] > pivot)
-                break;
-            up++;
-        }
-        for (int j = high; j > low; j--)
-        {
-            if (data[down] < pivot)
-                break;
-            down--;
-        }
-        if (up < down)
-            std::swap(data[up], data[down]);
+        // Search using quicksort
+        StateMap<T> scratch = data;
+        quickSortTop(scratch);
     }
-    std::swap(data[low], data[down]);
-    return down;
-}
-
-// Function to perform quicksort algorithm with pivot as last element
-template <typename T>
-void quickSort(std::vector<T>& data, int low, int high)
-{
-    if (low < high)
     {
-        int pivot = partition(data, low, high);
-        quickSort(data, low, pivot - 1);
-        quickSort(data, pivot + 1, high);
+        // Sort by the extracted keys with radix sort
+        StateMap<T> scratch = data;
+        radixSortData(scratch);
     }
-}
-
-// Define a template function for quick sorting
-template <typename T>
-void quickSortTop(std::map<std::string, std::vector<T>>& data){
-    auto start = std::chrono::high_resolution_clock ::now();
-
-    for (auto& entry : data){
-        std::vector<T>& dataSet = entry.second;
-        quickSort(dataSet, 0, dataSet.size() - 1);
+    {
+        StateMap<T> scratch = data;
+        shellSortData(scratch, pool);
+    }
+    {
+        StateMap<T> scratch = data;
+        quickSortTop(scratch, pool);
     }
-
-    auto stop = std::chrono::high_resolution_clock ::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop-start);
-    std::cout << "Quick Sort Time in Milliseconds: " <<  duration.count()/1000.0 << std::endl;
 }
 
 // Function that displays the shell sorted housing data to confirm it works
 // Mainly used for debugging
-void displayHouseInfo(std::map<std::string, std::vector<HouseInfo>>& HouseData, std::string FileName){
+void displayHouseInfo(HouseMap& HouseData, std::string FileName){
     std::ofstream homeOutputFile(FileName);
     for (auto& entry : HouseData){
-        std::vector<HouseInfo>& houses = entry.second;
+        std::pmr::vector<HouseInfo>& houses = entry.second;
         int n = houses.size();
         for (int i = 0; i < n; i++) {
-            homeOutputFile << houses[i].RegionID << ", " << houses[i].State << ", " << houses[i].City << ", " << houses[i].CountyName << ", " << std::fixed << std::setprecision(2) << houses[i].MeanValue << std::endl;
+            const StringPool& strings = stringPool();
+            homeOutputFile << strings.str(houses[i].RegionID) << ", " << strings.str(houses[i].State) << ", " << strings.str(houses[i].City) << ", " << strings.str(houses[i].CountyName) << ", " << std::fixed << std::setprecision(2) << houses[i].MeanValue << std::endl;
         }
     }
     homeOutputFile.close();
 }
 
-// Function to find the top 5 best cost of living states
-void top5States(
-        std::string title,
-        int numStates,
-        std::map<std::string, std::vector<HouseInfo>>& HouseData,
-        std::map<std::string, std::vector<Occupation>> occupationData
-) {
-    // Variables to store average job salary and average home value per state
-    std::map<std::string, float> advJobSalaryPerState;
-    std::map<std::string, float> advHomeValuePerState;
-
-    // Calculate average job salary per state
-    for (auto iter = occupationData.begin(); iter != occupationData.end(); ++iter) {
-        int total = 0, counter = 0;
-        for (const auto& occupation : iter->second) {
-            if (occupation.OCC_TITLE == title) {
-                total += occupation.A_MEAN;
-                counter += 1;
-            }
-        }
-
-        // Calculate and store the average job salary for the state
-        advJobSalaryPerState[iter->first] = (counter != 0) ? static_cast<float>(total) / counter : 0;
-    }
-
-    // Calculate average home value per state
-    for (auto iter = HouseData.begin(); iter != HouseData.end(); ++iter) {
-        int total = 0, counter = 0;
-        for (const auto& houseInfo : iter->second) {
-            total += houseInfo.MeanValue;
-            counter += 1;
-        }
-
-        // Calculate and store the average home value for the state
-        advHomeValuePerState[iter->first] = (counter != 0) ? static_cast<float>(total) / counter : 0;
-    }
-
-    // Calculate the advantage score for each state
-    std::map<std::string, float> houseAdv;
-    for (const auto& entry : advJobSalaryPerState) {
-        houseAdv[entry.first] = (entry.second != 0) ? (advJobSalaryPerState[entry.first]- (advHomeValuePerState[entry.first]/30.0)) : 0;
-    }
-
-    // Sort the states based on the advantage score in descending order
-    std::vector<std::pair<std::string, float>> vectorPairs(houseAdv.begin(), houseAdv.end());
-    std::sort(vectorPairs.begin(), vectorPairs.end(), [](const auto& a, const auto& b) {
-        return a.second > b.second;
-    });
-
-
-    // Select the top states and store their information
-    for (int i = 0; i < 5; ++i) {
-            const std::string& state = vectorPairs[i].first;
-            float jobSalary = advJobSalaryPerState[state];
-            float homeValue = advHomeValuePerState[state];
-            const std::vector<HouseInfo>& houseInfoVec = HouseData[state];
-
-            std::cout << "State: " << state << std::endl;
-            std::cout << "  Average Job Salary: " << jobSalary << std::endl;
-            std::cout << "  Average Home Value: " << homeValue << std::endl;
-            std::cout << "  Average Monthly Payment: " << (homeValue/360.0) << std::endl;
-            std::cout << "  Difference in Job Salary and Yearly Mortgage Payments: " << (jobSalary - (homeValue/30.0)) << std::endl;
-
-    }
+// Milliseconds since start, for --timing
+double millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+    auto stop = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() / 1000.0;
 }
 
-
-int main()
+// Function that runs the original menu: list the titles, search by keyword, pick one by number
+void runInteractive(const Dataset& dataset, ThreadPool& pool, std::size_t numStates, bool streaming)
 {
-    // Open input files for occupation salary data and home cost data
-    std::ifstream homeCostFile("../PropertyValues.csv");
-    std::ifstream OccupationDataFile("../JobSalarys.csv");
-
-    // Check if files are successfully opened
-    if (!homeCostFile.is_open())
-    {
-        std::cerr << "Error opening files!" << std::endl;
-        return 1;
-    }
-
-    // Map to store zip code information and salary information
-    std::map<std::string, std::vector<HouseInfo>> houseData;
-    // houseData is sorted by shell sort, unsortedHouseData is sorted by quick sort
-    // This is to ensure both sorting algorithms are being sorted on the same unsorted dataset
-    std::map<std::string, std::vector<HouseInfo>> unsortedHouseData;
-    std::map<std::string, std::vector<Occupation>> occupationData;
-    std::map<std::string, std::vector<Occupation>> unsortedOccupationData;
-    std::map<std::string, std::string> occupationNames;
-
-    // Read home cost data from the file
-    std::string homeCostLine;
-    std::getline(homeCostFile, homeCostLine);
-    while (std::getline(homeCostFile, homeCostLine))
-    {
-        std::istringstream iss(homeCostLine);
-        std::string RegionIDStr, StateStr, CityStr, CountyNameStr, MeanValueStr;
-
-        // Parse CSV fields
-        std::getline(iss, RegionIDStr, ',');
-        std::getline(iss, StateStr, ',');
-        std::getline(iss, CityStr, ',');
-        std::getline(iss, CountyNameStr, ',');
-        std::getline(iss, MeanValueStr, ',');
-
-        // Convert string values to appropriate types
-        double MeanValue = convertToDouble(MeanValueStr);
-
-        HouseInfo tmp = HouseInfo(RegionIDStr, StateStr, CityStr, CountyNameStr, MeanValue);
-        houseData[StateStr].push_back(tmp);
-        unsortedHouseData[StateStr].push_back(tmp);
-    }
-
-    // Read occupation data from the file
-    std::string OccupationDataLine;
-    std::getline(OccupationDataFile, OccupationDataLine);
-    while (std::getline(OccupationDataFile, OccupationDataLine))
-    {
-        std::istringstream iss(OccupationDataLine);
-        std::string AREA, PRIM_STATE, OCC_TITLE, S_TOT_EMP, S_A_MEAN;
-
-        // Parse CSV fields
-        std::getline(iss, AREA, ',');
-        std::getline(iss, PRIM_STATE, ',');
-        std::getline(iss, OCC_TITLE, ',');
-        std::getline(iss, S_TOT_EMP, ',');
-        std::getline(iss, S_A_MEAN, ',');
-
-        double TOT_EMP = convertToDouble(S_TOT_EMP);
-        double A_MEAN = convertToDouble(S_A_MEAN);
-
-        Occupation tmp = Occupation(AREA, PRIM_STATE, OCC_TITLE, TOT_EMP, A_MEAN);
-        occupationData[PRIM_STATE].push_back(tmp);
-        unsortedOccupationData[PRIM_STATE].push_back(tmp);
-        occupationNames[OCC_TITLE] = OCC_TITLE;
-    }
-
-    // Close input files
-    homeCostFile.close();
-    OccupationDataFile.close();
+    const std::set<std::string_view>& occupationNames = dataset.occupationNames;
 
     std::cout << "Welcome to Oh, the places you can go!" << std::endl;
     std::cout
@@ -347,7 +118,7 @@ int main()
     // Prints list of choices of occupations
     for (auto i = occupationNames.begin(); i != occupationNames.end(); i++)
     {
-        std::cout << i->second << std::endl;
+        std::cout << *i << std::endl;
     }
 
     std::cout << std::endl;
@@ -359,7 +130,7 @@ int main()
     std::string keyword;
     std::cin >> keyword;
 
-    std::set<std::string> matchingTitles = searchOccupations(occupationData, keyword);
+    std::vector<std::string> matchingTitles = searchOccupations(dataset, keyword);
     std::cout << std::endl;
     if (!matchingTitles.empty())
     {
@@ -384,39 +155,185 @@ int main()
             std::string selectedTitle = *it;
             std::cout << selectedTitle << std::endl;
 
-            // return best cost of living for the top 5 states
+            // return best cost of living for the top states
             std::cout << std::endl;
             std::cout << "Here are the top choices for you:" << std::endl;
             std::cout << std::endl;
-            top5States(selectedTitle, 5, houseData, occupationData);
+            top5States(selectedTitle, static_cast<int>(numStates), dataset);
+
+            // Compare shell sort and quicksort on the house data, then on the occupation data
+            // A streamed dataset kept no rows to sort
+            if (!streaming)
+            {
+                compareSorts(dataset.houseData, pool);
+                compareSorts(dataset.occupationData, pool);
+            }
 
-            // Return number of data points for house data
-            countRecords(unsortedHouseData);
-            std:: cout << std::endl;
+        }
+        loop = false;
+    }
+    else
+    {
+        std::cout << "No Occupation found. Try again." << std::endl;
+    }
+    }
+}
 
-            // Search using shell sort on house data
-            shellSortData(houseData);
+// Function that answers one --occupation query, returns the process exit code
+int runQuery(const Dataset& dataset, const CommandLine& options)
+{
+    std::vector<std::string> matches;
+    std::optional<std::string> title = resolveOccupation(dataset, options.occupation, matches);
+    if (!title)
+    {
+        // Nobody is there to pick one, so the candidates go to stderr for the caller to narrow it down
+        if (matches.empty())
+        {
+            std::cerr << "No Occupation found for '" << options.occupation << "'" << std::endl;
+        }
+        else
+        {
+            std::cerr << "'" << options.occupation << "' matches " << matches.size() << " occupations:" << std::endl;
+            for (const std::string& match : matches)
+            {
+                std::cerr << "  " << match << std::endl;
+            }
+        }
+        return 2;
+    }
+    std::vector<TitleRanking> rankings(1);
+    rankings[0].title = *title;
+    rankings[0].states = rankPlaces(*title, options.top, Granularity::State, dataset);
+    writeRankings(rankings, options.format, std::cout);
+    return 0;
+}
 
-            // Search using quicksort on house data
-            quickSortTop(unsortedHouseData);
+// Function that ranks states for every title of a --batch, returns the process exit code
+int runBatch(const Dataset& dataset, ThreadPool& pool, const CommandLine& options)
+{
+    std::vector<std::string> titles;
+    if (options.batch == "all")
+    {
+        titles = allTitles(dataset);
+    }
+    else if (!readTitleList(options.batch, titles))
+    {
+        std::cerr << "Error opening " << options.batch << std::endl;
+        return 1;
+    }
+    writeRankings(rankStatesBatch(titles, options.top, dataset, pool), options.format, std::cout);
+    return 0;
+}
 
-            // Return number of data points for occupation data
-            countRecords(occupationData);
-            std:: cout << std::endl;
+// Function that serves queries over a Unix domain socket until SIGINT or SIGTERM, returns the process exit code
+int runServer(const Dataset& dataset, ThreadPool& pool, const CommandLine& options)
+{
+    QueryServer server(dataset, pool);
+    std::string error;
+    if (!server.listen(options.socketPath, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    server.stopOnSignals();
+    std::cout << "Listening on " << options.socketPath << " with " << pool.size() << " worker threads" << std::endl;
+    server.run();
+    std::cout << "Answered " << server.requestsServed() << " queries" << std::endl;
+    return 0;
+}
 
-            // Search using shell sort on occupation data
-            shellSortData(occupationData);
+// Function that loads a running server and reports its latency and throughput, returns the process exit code
+int runLoadGenerator(const CommandLine& options)
+{
+    LoadReport report;
+    std::string error;
+    if (!runLoadTest(options.socketPath, options.clients, options.requests, report, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cout << "Requests: " << report.requests << " from " << options.clients << " clients, errors: "
+              << report.errors << std::endl;
+    std::cout << "Latency in Milliseconds: p50 " << report.p50Ms << ", p99 " << report.p99Ms << ", max "
+              << report.maxMs << std::endl;
+    std::cout << "Queries per second: " << report.queriesPerSecond() << std::endl;
+    return report.errors == 0 ? 0 : 1;
+}
 
-            // Search using quicksort on occupation data
-            quickSortTop(unsortedOccupationData);
+int main(int argc, char* argv[])
+{
+    // Internal to --bench: a fresh process whose peak memory is measured
+    if (argc > 4 && std::string(argv[1]) == "--bench-rss")
+    {
+        return runPeakResidentProbe(argv[2], argv[3], argv[4]);
+    }
 
-        }
-        loop = false;
+    CommandLine options;
+    std::string error;
+    if (!parseCommandLine(argc, argv, options, error))
+    {
+        std::cerr << error << std::endl << std::endl;
+        printUsage(std::cerr);
+        return 2;
     }
-    else
+    if (options.mode == RunMode::Help)
     {
-        std::cout << "No Occupation found. Try again." << std::endl;
+        printUsage(std::cout);
+        return 0;
     }
+    const std::string& dataDir = options.dataDir;
+
+    // Timing comparisons only, no interactive session
+    if (options.mode == RunMode::Bench)
+    {
+        return runBenchmarks(dataDir);
     }
-    return 0;
-}
\ No newline at end of file
+    // The load generator only talks to a server, so it needs no data of its own
+    if (options.mode == RunMode::LoadTest)
+    {
+        return runLoadGenerator(options);
+    }
+
+    // Zip code information and salary information, loaded once and then only read
+    // Read home cost data and occupation data from the files, both at once across all cores,
+    // or straight from the snapshot the previous run left behind if the files have not changed
+    // (kept next to the files unless --snapshot moves it or --no-snapshot turns it off).
+    // With --stream only the aggregates are kept: the files are streamed once and their rows never held,
+    // for inputs too large to load
+    std::string snapshotPath = options.snapshotPath.empty() ? dataDir + "/Project3.snapshot" : options.snapshotPath;
+    if (options.noSnapshot)
+    {
+        snapshotPath.clear();
+    }
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    ThreadPool pool;
+    DatasetHandle dataset = options.stream
+            ? streamDataset(dataDir + "/PropertyValues.csv", dataDir + "/JobSalarys.csv", pool)
+            : loadDataset(dataDir + "/PropertyValues.csv", dataDir + "/JobSalarys.csv", pool, snapshotPath);
+    if (!dataset)
+    {
+        std::cerr << "Error opening files!" << std::endl;
+        return 1;
+    }
+    if (options.timing)
+    {
+        std::cerr << "Load Time in Milliseconds: " << millisecondsSince(loadStart) << std::endl;
+    }
+
+    if (options.mode == RunMode::Interactive)
+    {
+        runInteractive(*dataset, pool, options.top, options.stream);
+        return 0;
+    }
+    if (options.mode == RunMode::Serve)
+    {
+        return runServer(*dataset, pool, options);
+    }
+    auto queryStart = std::chrono::high_resolution_clock::now();
+    int status = (options.mode == RunMode::Query) ? runQuery(*dataset, options) : runBatch(*dataset, pool, options);
+    if (options.timing)
+    {
+        std::cerr << "Query Time in Milliseconds: " << millisecondsSince(queryStart) << std::endl;
+    }
+    return status;
+}